@@ -1,16 +1,27 @@
 #include "actions.h"
 
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <avr/wdt.h>
+#include <util/crc16.h>
 #include <util/delay.h>
+#include <string.h>
 #include "display.h"
 #include "tuner/tuner.h"
 #include "temp.h"
 #include "adc.h"
 #include "alarm.h"
 #include "uart.h"
+#include "i2c.h"
+#include "eeprom.h"
+#include "timer.h"
 
 static uint8_t dispMode = MODE_STANDBY;
 static uint8_t dispModePrev = MODE_STANDBY;
 
+static uint8_t streamPeriod;						// UART telemetry, 10 ms units
+static uint8_t streamPart;
+
 static uint8_t defDispMode(void)
 {
 	uint8_t ret;
@@ -29,6 +40,176 @@ static uint8_t defDispMode(void)
 	return ret;
 }
 
+// Executes UART command and replies, RC-like ones are returned as action
+static uint8_t uartAction(UARTData *uart)
+{
+	uint8_t action = ACTION_NOACTION;
+	uint8_t status = UART_OK;
+	uint8_t data[UART_EEP_PART];
+	uint8_t *addr;
+	uint16_t crc = 0;
+	uint8_t i;
+	uint8_t len = 0;
+	uint8_t mode = uart->command;
+	const sndGrid *grid;
+
+	// EEPROM is written only in standby, when RAM copies are already saved,
+	// and new settings are taken after reset
+	if ((uart->type == UART_CMD_EEP_WRITE || uart->type == UART_CMD_RESET) &&
+		dispMode != MODE_STANDBY) {
+		uartReply(UART_ERR_STATE, 0, 0);
+		return action;
+	}
+
+	// Settings are not changed in standby (except power on), test and edit modes
+	if (uart->type >= UART_CMD_SET_PARAM && uart->type <= UART_CMD_SET_MODE) {
+		switch (dispMode) {
+		case MODE_STANDBY:
+			if (uart->type == UART_CMD_SET_MODE)
+				break;
+		case MODE_TEST:
+		case MODE_TEMP:
+		case MODE_TIME_EDIT:
+		case MODE_ALARM_EDIT:
+			uartReply(UART_ERR_STATE, 0, 0);
+			return action;
+		default:
+			break;
+		}
+	}
+
+	switch (uart->type) {
+	case UART_CMD_RC:
+		if (uart->command < CMD_RC_END)
+			action = uart->command;
+		else
+			status = UART_ERR_ARG;
+		break;
+	case UART_CMD_STATUS:
+		data[0] = dispMode;
+		data[1] = aproc.input;
+		data[2] = aproc.mute;
+		data[3] = aproc.extra;
+		data[4] = sndPar[MODE_SND_VOLUME].value;
+		data[5] = tuner.freq;
+		data[6] = tuner.freq >> 8;
+		len = 7;
+		break;
+	case UART_CMD_GET_PARAM:
+		if (mode >= MODE_SND_END) {
+			status = UART_ERR_ARG;
+			break;
+		}
+		grid = sndPar[mode].grid;
+		data[0] = sndPar[mode].value;
+		data[1] = pgm_read_byte(&grid->min);
+		data[2] = pgm_read_byte(&grid->max);
+		data[3] = pgm_read_byte(&grid->step);
+		len = 4;
+		break;
+	case UART_CMD_SET_PARAM:
+		// Parameters not supported by audioprocessor have zero step
+		if (mode >= MODE_SND_END || !pgm_read_byte(&sndPar[mode].grid->step)) {
+			status = UART_ERR_ARG;
+			break;
+		}
+		sndPar[mode].value = uart->value;
+		sndSetMute(0);
+		sndChangeParam(mode, 0);
+		dispMode = mode;
+		setDisplayTime(DISPLAY_TIME_GAIN);
+		data[0] = sndPar[mode].value;
+		len = 1;
+		break;
+	case UART_CMD_SET_INPUT:
+		if (uart->command < aproc.inCnt)
+			action = CMD_RC_IN_0 + uart->command;
+		else
+			status = UART_ERR_ARG;
+		break;
+	case UART_CMD_SET_FREQ:
+		if (!tuner.ic) {
+			status = UART_ERR_STATE;
+			break;
+		}
+		tuner.freq = uart->value;
+		tunerSetFreq();
+		if (!aproc.input) {
+			dispMode = MODE_FM_RADIO;
+			setDisplayTime(DISPLAY_TIME_FM_RADIO);
+		}
+		data[0] = tuner.freq;
+		data[1] = tuner.freq >> 8;
+		len = 2;
+		break;
+	case UART_CMD_SET_MODE:
+		if (mode == MODE_STANDBY) {
+			if (dispMode != MODE_STANDBY)
+				action = CMD_RC_STBY;
+		} else if (dispMode == MODE_STANDBY) {
+			// Screen is chosen by power on sequence
+			action = ACTION_EXIT_STANDBY;
+		} else if (mode < MODE_SND_END) {
+			dispMode = mode;
+			setDisplayTime(DISPLAY_TIME_GAIN);
+		} else if (mode == MODE_SPECTRUM || mode == MODE_TIME ||
+				   (mode == MODE_FM_RADIO && tuner.ic)) {
+			setDefDisplay(mode);
+			dispMode = defDispMode();
+			setDisplayTime(DISPLAY_TIME_SP);
+		} else {
+			status = UART_ERR_ARG;
+		}
+		break;
+	case UART_CMD_STREAM:
+		streamPeriod = uart->command;
+		if (streamPeriod)
+			timerArm(TIMER_STREAM, streamPeriod * 10);
+		else
+			timerCancel(TIMER_STREAM);
+		break;
+	case UART_CMD_EEP_CRC:
+		if (uart->command >= EEPROM_SIZE / UART_EEP_BLOCK) {
+			status = UART_ERR_ARG;
+			break;
+		}
+		addr = (uint8_t*)0 + uart->command * UART_EEP_BLOCK;
+		for (i = 0; i < UART_EEP_BLOCK; i++)
+			crc = _crc16_update(crc, eeprom_read_byte(addr++));
+		data[0] = crc;
+		data[1] = crc >> 8;
+		len = 2;
+		break;
+	case UART_CMD_EEP_READ:
+	case UART_CMD_EEP_WRITE:
+		if (uart->data[0] >= EEPROM_SIZE / UART_EEP_BLOCK ||
+			uart->data[1] >= UART_EEP_BLOCK / UART_EEP_PART) {
+			status = UART_ERR_ARG;
+			break;
+		}
+		addr = (uint8_t*)0 + uart->data[0] * UART_EEP_BLOCK + uart->data[1] * UART_EEP_PART;
+		if (uart->type == UART_CMD_EEP_WRITE) {
+			// Only changed bytes are written, up to 55 ms for a part
+			eeprom_update_block(&uart->data[2], addr, UART_EEP_PART);
+		} else {
+			eeprom_read_block(data, addr, UART_EEP_PART);
+			len = UART_EEP_PART;
+		}
+		break;
+	case UART_CMD_RESET:
+		uartReply(status, data, len);
+		uartFlush();
+		wdt_enable(WDTO_15MS);
+		while (1);
+	default:
+		break;
+	}
+
+	uartReply(status, data, len);
+
+	return action;
+}
+
 uint8_t getAction(void)
 {
 	uint8_t action = ACTION_NOACTION;
@@ -47,10 +228,8 @@ uint8_t getAction(void)
 
 	/* Handle commands from UART */
 	UARTData uartData = getUartData();
-	if (uartData.type == UART_CMD_RC) {
-		if (uartData.command < CMD_RC_END)
-			action = uartData.command;
-	}
+	if (uartData.type != UART_CMD_NO)
+		action = uartAction(&uartData);
 
 	/* Handle commands from buttons*/
 	switch (cmd) {
@@ -109,7 +288,8 @@ uint8_t getAction(void)
 		action = CMD_RC_FM_MODE;
 		break;
 	case CMD_BTN_5_LONG:
-		// Reserved for future purposes
+		if (dispMode == MODE_FM_TUNE || dispMode == MODE_FM_RADIO)
+			action = ACTION_FM_SCAN;
 		break;
 
 	case CMD_BTN_12_LONG:
@@ -181,6 +361,7 @@ uint8_t getAction(void)
 			action != CMD_RC_VOL_DOWN && action != CMD_RC_VOL_UP &&
 			action != CMD_RC_FM_MODE && action != CMD_RC_FM_STORE &&
 			action != CMD_RC_FM_DEC && action != CMD_RC_FM_INC &&
+			action != ACTION_FM_SCAN &&
 			(action < CMD_RC_FM_0 || action > CMD_RC_FM_9)
 			)
 			action = ACTION_NOACTION;
@@ -194,6 +375,10 @@ void handleAction(uint8_t action)
 {
 	int16_t stbyTimer = STBY_TIMER_OFF;
 
+	// Any other action stops FM scan
+	if (action != ACTION_NOACTION && action != ACTION_FM_SCAN)
+		tunerScanStop();
+
 	switch (action) {
 	case ACTION_EXIT_STANDBY:
 		PORT(STMU_STBY) |= STMU_STBY_LINE;	/* Power up audio and tuner */
@@ -221,11 +406,13 @@ void handleAction(uint8_t action)
 		tunerPowerOff();
 		displayPowerOff();
 
+		I2CWait();							/* Mute must reach chips before power is off */
 		PORT(STMU_STBY) &= ~STMU_STBY_LINE;
 
 		setStbyBrightness();
 		rtc.etm = RTC_NOEDIT;
 		alarmSave();
+		eepromCommit();						/* Write back all changed settings */
 		setStbyTimer(STBY_TIMER_OFF);
 		disableSilenceTimer();
 		setInitTimer(INIT_TIMER_OFF);
@@ -234,7 +421,6 @@ void handleAction(uint8_t action)
 	case CMD_RC_TIMER:
 		rtc.etm = RTC_NOEDIT;
 		if (dispMode == MODE_TIMER) {
-			setSecTimer(2000);
 			stbyTimer = getStbyTimer();
 			if (stbyTimer < 120)			/* 2 min */
 				setStbyTimer(120);
@@ -389,6 +575,14 @@ void handleAction(uint8_t action)
 			break;
 		}
 		break;
+	case ACTION_FM_SCAN:
+		if (tunerScanning()) {
+			tunerScanStop();
+		} else if (!aproc.input && tuner.ic && tunerScanStart()) {
+			dispMode = MODE_FM_TUNE;
+			setDisplayTime(DISPLAY_TIME_FM_TUNE);
+		}
+		break;
 	default:
 		if (!aproc.input && tuner.ic) {
 			switch (action) {
@@ -455,6 +649,7 @@ void handleAction(uint8_t action)
 void handleEncoder(int8_t encCnt)
 {
 	if (encCnt) {
+		tunerScanStop();
 		switch (dispMode) {
 		case MODE_STANDBY:
 			break;
@@ -518,25 +713,52 @@ void handleChangeFM(uint8_t step)
 	return;
 }
 
+// Next part of spectrum goes to UART with current state
+void handleStream(void)
+{
+	uint8_t data[UART_STREAM_LEN];
+	uint16_t level = getSignalLevel();
+
+	data[0] = streamPart;
+	data[1] = FFT_SIZE;
+	data[2] = dispMode;
+	data[3] = sndPar[MODE_SND_VOLUME].value;
+	data[4] = level;
+	data[5] = level >> 8;
+	memcpy(&data[6], &buf[streamPart * UART_STREAM_BINS], UART_STREAM_BINS);
+	uartStream(data, sizeof(data));
+
+	if (++streamPart >= FFT_SIZE / UART_STREAM_BINS)
+		streamPart = 0;
+
+	if (streamPeriod)
+		timerArm(TIMER_STREAM, streamPeriod * 10);
+
+	return;
+}
+
+void handleFmScan(void)
+{
+	if (tunerScanning())
+		setDisplayTime(DISPLAY_TIME_FM_TUNE);
+	tunerScanProcess();
+
+	return;
+}
+
 uint8_t checkAlarmAndTime(void)
 {
 	uint8_t ret = ACTION_NOACTION;
 
-	if (getClockTimer() == 0) {
-		rtcReadTime();
-
-		if (dispMode == MODE_STANDBY) {
-			if ((rtc.sec == 0) &&
-				(rtc.min == alarm0.min) &&
-				(rtc.hour == alarm0.hour) &&
-				(alarm0.wday & (0x40 >> ((rtc.wday + 5) % 7)))
-				) {
-				sndSetInput(alarm0.input);
-				ret = ACTION_EXIT_STANDBY;
-			}
+	if (dispMode == MODE_STANDBY) {
+		if ((rtc.sec == 0) &&
+			(rtc.min == alarm0.min) &&
+			(rtc.hour == alarm0.hour) &&
+			(alarm0.wday & (0x40 >> ((rtc.wday + 5) % 7)))
+			) {
+			sndSetInput(alarm0.input);
+			ret = ACTION_EXIT_STANDBY;
 		}
-
-		setClockTimer(200);					/* Limit check interval */
 	}
 
 	return ret;
@@ -590,18 +812,44 @@ void handleTimers(void)
 	return;
 }
 
-void handleModeChange(void)
+uint8_t handleModeChange(void)
 {
-	if (dispMode != dispModePrev)
-		displayClear();
+	if (dispMode == dispModePrev)
+		return 0;
 
-	return;
+	displayClear();
+
+	return 1;
 }
 
-void showScreen(void)
+// Events that change data shown in current mode
+uint8_t screenEvents(void)
 {
-	getSpectrum();
+	switch (dispMode) {
+	case MODE_STANDBY:
+	case MODE_TIME:
+		return EVENT_TIME;
+	case MODE_TIME_EDIT:
+	case MODE_ALARM_EDIT:
+	case MODE_TIMER:
+	case MODE_SILENCE_TIMER:
+	case MODE_TEST:
+		return EVENT_BLINK;
+	case MODE_TEMP:
+		return EVENT_TEMP;
+	case MODE_FM_RADIO:
+	case MODE_FM_TUNE:
+		return EVENT_TUNER;
+	case MODE_ALARM:
+	case MODE_BR:
+		return 0;
+	default:
+		return EVENT_SPECTRUM;
+	}
+}
 
+void showScreen(void)
+{
 	switch (dispMode) {
 	case MODE_STANDBY:
 		showTime();
@@ -31,6 +31,7 @@ enum {
 	ACTION_INIT_HARDWARE,
 	ACTION_TESTMODE,
 	ACTION_TEMPMODE,
+	ACTION_FM_SCAN,
 
 	ACTION_NOACTION
 };
@@ -66,12 +67,15 @@ uint8_t getAction(void);
 void handleAction(uint8_t action);
 void handleEncoder(int8_t encCnt);
 void handleChangeFM(uint8_t step);
+void handleFmScan(void);
+void handleStream(void);
 
 uint8_t checkAlarmAndTime(void);
 
 void handleExitDefaultMode(void);
 void handleTimers(void);
-void handleModeChange(void);
+uint8_t handleModeChange(void);
+uint8_t screenEvents(void);
 
 void showScreen(void);
 
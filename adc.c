@@ -5,17 +5,20 @@
 #include <avr/pgmspace.h>
 #include <avr/eeprom.h>
 #include "eeprom.h"
+#include "input.h"
 
 static int16_t fr[FFT_SIZE];					// Real values
 static int16_t fi[FFT_SIZE];					// Imaginary values
 uint8_t buf[FFT_SIZE];							// Previous results: left and right
 
-static const uint8_t hannTable[] PROGMEM = {
-	  0,   1,   3,   6,  10,  16,  22,  30,
-	 38,  48,  58,  69,  81,  93, 105, 118,
-	131, 143, 156, 168, 180, 191, 202, 212,
-	221, 229, 236, 242, 247, 251, 254, 255,
-};
+static volatile uint8_t adcBuf[2][FFT_SIZE];	// Ping-pong sample buffers
+static volatile uint8_t adcMux[2];				// Channel captured in buffer
+static volatile uint8_t adcFull[2];				// Buffer is ready for FFT
+static volatile uint8_t adcWr;					// Buffer being captured
+static volatile uint8_t adcCnt;					// Samples in buffer being captured
+
+static const uint8_t hannTable[FFT_SIZE / 2] PROGMEM = FFT_HANN_TABLE;
+static const uint8_t revTable[FFT_SIZE] PROGMEM = FFT_REV_TABLE;
 
 static const int16_t dbTable[N_DB - 1] PROGMEM = {
 	   1,    1,    2,    2,    3,    4,    6,    8,
@@ -26,74 +29,98 @@ static const int16_t dbTable[N_DB - 1] PROGMEM = {
 
 void adcInit(void)
 {
-	/* Enable ADC with prescaler 16 */
-	ADCSRA = (1<<ADEN) | (1<<ADPS2) | (0<<ADPS1) | (0<<ADPS0);
+	/* Enable ADC with prescaler 16 and conversion complete interrupt */
+	ADCSRA = (1<<ADEN) | (1<<ADIE) | (1<<ADPS2) | (0<<ADPS1) | (0<<ADPS0);
 	ADMUX |= (1<<ADLAR);						// Adjust result to left (8bit ADC)
 
+	ADMUX &= ~((1<<MUX2) | (1<<MUX1) | (1<<MUX0));
+	ADMUX |= MUX_LEFT;
+	adcMux[0] = MUX_LEFT;
+
 	TIMSK |= (1<<TOIE0);						// Enable Timer0 overflow interrupt
 	TCCR0 |= (0<<CS02) | (1<<CS01) | (0<<CS00);	// Set timer prescaller to 8 (2MHz)
 
 	return;
 }
 
-static uint8_t revBits(uint8_t x)
+ISR(ADC_vect)
 {
-	x = ((x & 0x15) << 1) | ((x & 0x2A) >> 1);	// 00abcdef => 00badcfe
-	x = (x & 0x0C) | swap(x & 0x33);			// 00badcfe => 00fedcba
+	uint8_t mux;
 
-	return x;
-}
+	// Conversions are started by display ISR, skip them while both buffers are busy
+	if (adcFull[adcWr])
+		return;
 
-static void getValues(uint8_t mux)
-{
-	uint8_t i = 0;
+	adcBuf[adcWr][adcCnt] = ADCH;
 
-	ADMUX &= ~((1<<MUX2) | (1<<MUX1) | (1<<MUX0));
-	ADMUX |= mux;
+	if (++adcCnt >= FFT_SIZE) {
+		adcCnt = 0;
 
-	for (i = 0; i < FFT_SIZE; i++) {
-		while (!(ADCSRA & (1<<ADSC)));			// Wait for start measure
-		while (ADCSRA & (1<<ADSC));				// Wait for finish measure
+		// Capture next channel in other buffer
+		mux = adcMux[adcWr] == MUX_LEFT ? MUX_RIGHT : MUX_LEFT;
+		ADMUX &= ~((1<<MUX2) | (1<<MUX1) | (1<<MUX0));
+		ADMUX |= mux;
+
+		adcFull[adcWr] = 1;
+		adcWr = !adcWr;
+		adcMux[adcWr] = mux;
 
-		fi[i] = ADCH;							// Store in FI for futher handling
+		if (adcFull[adcWr])						// Both channels are captured
+			setEvent(EVENT_SPECTRUM);
 	}
+}
 
-	return;
+static uint8_t adcBlocksReady(void)
+{
+	// Left and right channels are handled by one FFT run
+	return adcFull[0] && adcFull[1];
 }
 
-static void prepareData(void)
+static void windowData(int16_t *out, const uint8_t *in)
 {
-	uint8_t i, j;
+	uint8_t i;
 	int16_t dcOft = 0;
 	uint8_t hw;
 
 	// Calculate average DC offset
 	for (i = 0; i < FFT_SIZE; i++)
-		dcOft += fi[i];
+		dcOft += in[i];
 	dcOft /= FFT_SIZE;
 
-	// Move FI => FR with reversing bit order in index
+	// Move samples => out with reversing bit order in index
+	// Scaling by 64 / FFT_SIZE keeps levels independent of FFT size
 	for (i = 0; i < FFT_SIZE; i++) {
-		j = revBits(i);
-		hw = pgm_read_byte(&hannTable[i < 32 ? i : 63 - i]);
-		fr[j] = ((fi[i] - dcOft) * hw) >> 6;
-		fi[i] = 0;
+		hw = pgm_read_byte(&hannTable[i < FFT_SIZE / 2 ? i : FFT_SIZE - 1 - i]);
+		out[pgm_read_byte(&revTable[i])] = ((in[i] - dcOft) * hw) >> FFT_LOG2;
 	}
 
 	return;
 }
 
+static void prepareData(void)
+{
+	uint8_t left = (adcMux[0] != MUX_LEFT);
+
+	// Left channel goes to real part, right channel to imaginary part
+	windowData(fr, (const uint8_t *)adcBuf[left]);
+	windowData(fi, (const uint8_t *)adcBuf[!left]);
+
+	return;
+}
+
 static void cplx2dB(int16_t *fr, int16_t *fi)
 {
-	uint8_t i, j;
-	int16_t calc;
+	uint8_t i, j, step;
+	uint16_t calc;
 
-	for (i = 0; i < FFT_SIZE / 2; i++) {
+	for (i = 0; i < FFT_SIZE; i++) {
 		calc = ((int32_t)fr[i] * fr[i] + (int32_t)fi[i] * fi[i]) >> 13;
 
-		for (j = 0; j < N_DB - 1; j++)
-			if (calc <= pgm_read_word(&dbTable[j]))
-				break;
+		// Binary search for number of dbTable values below calc
+		j = 0;
+		for (step = N_DB / 2; step; step >>= 1)
+			if (calc > (uint16_t)pgm_read_word(&dbTable[j + step - 1]))
+				j += step;
 		fr[i] = j;
 	}
 
@@ -103,23 +130,24 @@ static void cplx2dB(int16_t *fr, int16_t *fi)
 void getSpData(uint8_t fallSpeed)
 {
 	uint8_t i;
-	uint8_t *p;
-	uint8_t mux;
+	uint8_t *p = buf;
+
+	if (!adcBlocksReady())
+		return;
 
-	for (mux = MUX_LEFT; mux <= MUX_RIGHT; mux++) {
-		getValues(mux);
-		prepareData();
-		fftRad4(fr, fi);
-		cplx2dB(fr, fi);
+	prepareData();
+	adcFull[0] = 0;								// Buffers can be captured again
+	adcFull[1] = 0;
 
-		p = &buf[(mux - MUX_LEFT) * FFT_SIZE / 2];
+	fftRad4(fr, fi);
+	fftSplit(fr, fi);							// Left => 0..SP_BINS-1, right => SP_BINS..FFT_SIZE-1
+	cplx2dB(fr, fi);
 
-		for (i = 0; i < FFT_SIZE / 2; i++) {
-			(*p > fallSpeed) ? (*p -= fallSpeed) : (*p = 1);
-			if ((*p)-- <= fr[i])
-				*p = fr[i];
-			p++;
-		}
+	for (i = 0; i < FFT_SIZE; i++) {
+		(*p > fallSpeed) ? (*p -= fallSpeed) : (*p = 1);
+		if ((*p)-- <= fr[i])
+			*p = fr[i];
+		p++;
 	}
 
 	return;
@@ -133,5 +161,5 @@ uint16_t getSignalLevel(void)
 	for (i = 0; i < sizeof(buf); i++)
 		ret += buf[i];
 
-	return ret * 3 / 64;
+	return ret * 3 / sizeof(buf);
 }
@@ -5,11 +5,11 @@
 
 #include "fft.h"
 
-#define swap(x) (__builtin_avr_swap(x))		//  Swaps nibbles in byte
-
 #define MUX_LEFT			0
 #define MUX_RIGHT			1
 
+#define SP_BINS				(FFT_SIZE / 2)	// Spectrum bins per channel
+
 extern uint8_t buf[FFT_SIZE];				// Previous results: left and right
 
 void adcInit(void);
@@ -13,13 +13,14 @@ const static ALARM_type alarmMax PROGMEM = {23, 59, 6, 0x7F, ALARM_NOEDIT};
 void alarmInit(void)
 {
 	eeprom_read_block(&alarm0, (void*)EEPROM_A0_HOUR, sizeof(ALARM_type) - 1);
+	eepromBind(EEPROM_BLOCK_ALARM, &alarm0, (void*)EEPROM_A0_HOUR, sizeof(ALARM_type) - 1);
 
 	return;
 }
 
 void alarmSave(void)
 {
-	eeprom_update_block(&alarm0, (void*)EEPROM_A0_HOUR, sizeof(ALARM_type) - 1);
+	eepromDirty(EEPROM_BLOCK_ALARM);
 	alarm0.eam = ALARM_NOEDIT;
 
 	return;
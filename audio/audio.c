@@ -57,10 +57,13 @@ static void setNothing(void)
 void sndInit(void)
 {
 	uint8_t i;
+	uint16_t volume;
 
 	/* Load audio parameters stored in eeprom */
 	for (i = 0; i < MODE_SND_END; i++)
 		sndPar[i].value = eeprom_read_byte((uint8_t*)EEPROM_VOLUME + i);
+	if (eepromLogRead((uint8_t*)EEPROM_LOG_VOLUME, &volume))
+		sndPar[MODE_SND_VOLUME].value = volume;
 	eeprom_read_block(&aproc, (void*)EEPROM_AUDIOPROC, sizeof(Audioproc_type) - 1);
 
 #if   !defined(_TDA7439) && !defined(_TDA731X) && !defined(_TDA7448) && !defined(_PT232X) && !defined(_TEA63X0) && !defined(_PGA2310) && !defined(_RDA580X_AUDIO)
@@ -493,7 +496,9 @@ void sndPowerOff(void)
 {
 	uint8_t i;
 
-	for (i = 0; i < MODE_SND_END; i++)
+	// Volume changes often, it goes to log to spread EEPROM wear
+	eepromLogWrite((uint8_t*)EEPROM_LOG_VOLUME, (uint8_t)sndPar[MODE_SND_VOLUME].value);
+	for (i = MODE_SND_VOLUME + 1; i < MODE_SND_END; i++)
 		eeprom_update_byte((uint8_t*)EEPROM_VOLUME + i, sndPar[i].value);
 
 	eeprom_update_byte((uint8_t*)EEPROM_APROC_EXTRA, aproc.extra);
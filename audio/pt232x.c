@@ -6,17 +6,17 @@
 
 void pt232xReset()
 {
-	I2CStart(PT2322_I2C_ADDR);
-	I2CWriteByte(PT2322_CREAR_REGS);
-	I2CStop();
+	I2CQueueStart(PT2322_I2C_ADDR);
+	I2CQueueByte(PT2322_CREAR_REGS);
+	I2CQueueEnd();
 
-	I2CStart(PT2322_I2C_ADDR);
-	I2CWriteByte(PT2322_INPUT_SW);
-	I2CStop();
+	I2CQueueStart(PT2322_I2C_ADDR);
+	I2CQueueByte(PT2322_INPUT_SW);
+	I2CQueueEnd();
 
-	I2CStart(PT2323_I2C_ADDR);
-	I2CWriteByte(PT2323_UNMUTE_ALL);
-	I2CStop();
+	I2CQueueStart(PT2323_I2C_ADDR);
+	I2CQueueByte(PT2323_UNMUTE_ALL);
+	I2CQueueEnd();
 
 	return;
 }
@@ -25,10 +25,10 @@ void pt2322SetVolume(void)
 {
 	int8_t val = -sndPar[MODE_SND_VOLUME].value;
 
-	I2CStart(PT2322_I2C_ADDR);
-	I2CWriteByte(PT2322_VOL_HI | (val / 10));
-	I2CWriteByte(PT2322_VOL_LO | (val % 10));
-	I2CStop();
+	I2CQueueStart(PT2322_I2C_ADDR);
+	I2CQueueByte(PT2322_VOL_HI | (val / 10));
+	I2CQueueByte(PT2322_VOL_LO | (val % 10));
+	I2CQueueEnd();
 
 	return;
 }
@@ -39,13 +39,13 @@ void pt2322SetBMT(void)
 	uint8_t mode = MODE_SND_BASS;
 	uint8_t param = PT2322_BASS;
 
-	I2CStart(PT2322_I2C_ADDR);
+	I2CQueueStart(PT2322_I2C_ADDR);
 	while (mode <= MODE_SND_TREBLE) {
 		val = sndPar[mode++].value;
-		I2CWriteByte(param | (val > 0 ? 15 - val : 7 + val));
+		I2CQueueByte(param | (val > 0 ? 15 - val : 7 + val));
 		param += 0b00010000;
 	}
-	I2CStop();
+	I2CQueueEnd();
 
 	return;
 }
@@ -74,22 +74,22 @@ void pt2322SetSpeakers(void)
 	sp[PT2322_CH_CT] = -sndPar[MODE_SND_CENTER].value;
 	sp[PT2322_CH_SB] = -sndPar[MODE_SND_SUBWOOFER].value;
 
-	I2CStart(PT2322_I2C_ADDR);
+	I2CQueueStart(PT2322_I2C_ADDR);
 	for (i = 0; i < PT2322_CH_END; i++) {
 		// PT2322_TRIM_XX
-		I2CWriteByte(((i + 1) << 4) | sp[i]);
+		I2CQueueByte(((i + 1) << 4) | sp[i]);
 	}
-	I2CStop();
+	I2CQueueEnd();
 
 	return;
 }
 
 void pt2323SetInput(void)
 {
-	I2CStart(PT2323_I2C_ADDR);
-	I2CWriteByte(PT2323_INPUT_SWITCH | (PT2323_INPUT_ST1 - aproc.input));
-	I2CWriteByte(PT2323_MIX | sndPar[MODE_SND_GAIN0 + aproc.input].value);
-	I2CStop();
+	I2CQueueStart(PT2323_I2C_ADDR);
+	I2CQueueByte(PT2323_INPUT_SWITCH | (PT2323_INPUT_ST1 - aproc.input));
+	I2CQueueByte(PT2323_MIX | sndPar[MODE_SND_GAIN0 + aproc.input].value);
+	I2CQueueEnd();
 
 	return;
 }
@@ -105,13 +105,13 @@ void pt232xSetSndFunc(void)
 	if (aproc.extra & APROC_EXTRA_TONEDEFEAT)
 		sndFunc |= PT2322_TONE_OFF;
 
-	I2CStart(PT2322_I2C_ADDR);
-	I2CWriteByte(sndFunc);
-	I2CStop();
+	I2CQueueStart(PT2322_I2C_ADDR);
+	I2CQueueByte(sndFunc);
+	I2CQueueEnd();
 
-	I2CStart(PT2323_I2C_ADDR);
-	I2CWriteByte(PT2323_ENH_SURR | !(aproc.extra & APROC_EXTRA_SURROUND));
-	I2CStop();
+	I2CQueueStart(PT2323_I2C_ADDR);
+	I2CQueueByte(PT2323_ENH_SURR | !(aproc.extra & APROC_EXTRA_SURROUND));
+	I2CQueueEnd();
 
 	return;
 }
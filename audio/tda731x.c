@@ -5,9 +5,9 @@
 
 void tda731xSetVolume(void)
 {
-	I2CStart(TDA731X_I2C_ADDR);
-	I2CWriteByte(TDA731X_VOLUME | -sndPar[MODE_SND_VOLUME].value);
-	I2CStop();
+	I2CQueueStart(TDA731X_I2C_ADDR);
+	I2CQueueByte(TDA731X_VOLUME | -sndPar[MODE_SND_VOLUME].value);
+	I2CQueueEnd();
 
 	return;
 }
@@ -16,12 +16,12 @@ void tda731xSetBT(void)
 {
 	int8_t val;
 
-	I2CStart(TDA731X_I2C_ADDR);
+	I2CQueueStart(TDA731X_I2C_ADDR);
 	val = sndPar[MODE_SND_BASS].value;
-	I2CWriteByte(TDA731X_BASS | (val > 0 ? 15 - val : 7 + val));
+	I2CQueueByte(TDA731X_BASS | (val > 0 ? 15 - val : 7 + val));
 	val = sndPar[MODE_SND_TREBLE].value;
-	I2CWriteByte(TDA731X_TREBLE | (val > 0 ? 15 - val : 7 + val));
-	I2CStop();
+	I2CQueueByte(TDA731X_TREBLE | (val > 0 ? 15 - val : 7 + val));
+	I2CQueueEnd();
 
 	return;
 }
@@ -49,37 +49,37 @@ void tda731xSetSpeakers(void)
 		spFrontRight += sndPar[MODE_SND_FRONTREAR].value;
 	}
 
-	I2CStart(TDA731X_I2C_ADDR);
-	I2CWriteByte(TDA731X_SP_REAR_LEFT | -spRearLeft);
-	I2CWriteByte(TDA731X_SP_REAR_RIGHT | -spRearRight);
-	I2CWriteByte(TDA731X_SP_FRONT_LEFT | -spFrontLeft);
-	I2CWriteByte(TDA731X_SP_FRONT_RIGHT | -spFrontRight);
-	I2CStop();
+	I2CQueueStart(TDA731X_I2C_ADDR);
+	I2CQueueByte(TDA731X_SP_REAR_LEFT | -spRearLeft);
+	I2CQueueByte(TDA731X_SP_REAR_RIGHT | -spRearRight);
+	I2CQueueByte(TDA731X_SP_FRONT_LEFT | -spFrontLeft);
+	I2CQueueByte(TDA731X_SP_FRONT_RIGHT | -spFrontRight);
+	I2CQueueEnd();
 
 	return;
 }
 
 void tda731xSetInput(void)
 {
-	I2CStart(TDA731X_I2C_ADDR);
-	I2CWriteByte(TDA731X_SW | (3 - sndPar[MODE_SND_GAIN0 + aproc.input].value) << 3 | !(aproc.extra & APROC_EXTRA_LOUDNESS) << 2 | aproc.input);
-	I2CStop();
+	I2CQueueStart(TDA731X_I2C_ADDR);
+	I2CQueueByte(TDA731X_SW | (3 - sndPar[MODE_SND_GAIN0 + aproc.input].value) << 3 | !(aproc.extra & APROC_EXTRA_LOUDNESS) << 2 | aproc.input);
+	I2CQueueEnd();
 
 	return;
 }
 
 void tda731xSetMute(void)
 {
-	I2CStart(TDA731X_I2C_ADDR);
+	I2CQueueStart(TDA731X_I2C_ADDR);
 	if (aproc.mute) {
-		I2CWriteByte(TDA731X_SP_REAR_LEFT | TDA731X_MUTE);
-		I2CWriteByte(TDA731X_SP_REAR_RIGHT | TDA731X_MUTE);
-		I2CWriteByte(TDA731X_SP_FRONT_LEFT | TDA731X_MUTE);
-		I2CWriteByte(TDA731X_SP_FRONT_RIGHT | TDA731X_MUTE);
+		I2CQueueByte(TDA731X_SP_REAR_LEFT | TDA731X_MUTE);
+		I2CQueueByte(TDA731X_SP_REAR_RIGHT | TDA731X_MUTE);
+		I2CQueueByte(TDA731X_SP_FRONT_LEFT | TDA731X_MUTE);
+		I2CQueueByte(TDA731X_SP_FRONT_RIGHT | TDA731X_MUTE);
 	} else {
 		tda731xSetSpeakers();
 	}
-	I2CStop();
+	I2CQueueEnd();
 
 	return;
 }
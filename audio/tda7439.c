@@ -20,11 +20,11 @@ void tda7439SetSpeakers(void)
 			spRight = volMin;
 	}
 
-	I2CStart(TDA7439_I2C_ADDR);
-	I2CWriteByte(TDA7439_VOLUME_RIGHT | TDA7439_AUTO_INC);
-	I2CWriteByte(-spRight);
-	I2CWriteByte(-spLeft);
-	I2CStop();
+	I2CQueueStart(TDA7439_I2C_ADDR);
+	I2CQueueByte(TDA7439_VOLUME_RIGHT | TDA7439_AUTO_INC);
+	I2CQueueByte(-spRight);
+	I2CQueueByte(-spLeft);
+	I2CQueueEnd();
 
 	return;
 }
@@ -34,34 +34,34 @@ void tda7439SetBMT(void)
 	int8_t val;
 	uint8_t mode;
 
-	I2CStart(TDA7439_I2C_ADDR);
-	I2CWriteByte(TDA7439_BASS | TDA7439_AUTO_INC);
+	I2CQueueStart(TDA7439_I2C_ADDR);
+	I2CQueueByte(TDA7439_BASS | TDA7439_AUTO_INC);
 	for (mode = MODE_SND_BASS; mode <= MODE_SND_TREBLE; mode++) {
 		val = sndPar[mode].value;
-		I2CWriteByte(val > 0 ? 15 - val : 7 + val);
+		I2CQueueByte(val > 0 ? 15 - val : 7 + val);
 	}
-	I2CStop();
+	I2CQueueEnd();
 
 	return;
 }
 
 void tda7439SetPreamp(void)
 {
-	I2CStart(TDA7439_I2C_ADDR);
-	I2CWriteByte(TDA7439_PREAMP);
-	I2CWriteByte(-sndPar[MODE_SND_PREAMP].value);
-	I2CStop();
+	I2CQueueStart(TDA7439_I2C_ADDR);
+	I2CQueueByte(TDA7439_PREAMP);
+	I2CQueueByte(-sndPar[MODE_SND_PREAMP].value);
+	I2CQueueEnd();
 
 	return;
 }
 
 void tda7439SetInput(void)
 {
-	I2CStart(TDA7439_I2C_ADDR);
-	I2CWriteByte(TDA7439_INPUT_SELECT | TDA7439_AUTO_INC);
-	I2CWriteByte(TDA7439_IN_CNT - 1 - aproc.input);
-	I2CWriteByte(sndPar[MODE_SND_GAIN0 + aproc.input].value);
-	I2CStop();
+	I2CQueueStart(TDA7439_I2C_ADDR);
+	I2CQueueByte(TDA7439_INPUT_SELECT | TDA7439_AUTO_INC);
+	I2CQueueByte(TDA7439_IN_CNT - 1 - aproc.input);
+	I2CQueueByte(sndPar[MODE_SND_GAIN0 + aproc.input].value);
+	I2CQueueEnd();
 
 	return;
 }
@@ -69,11 +69,11 @@ void tda7439SetInput(void)
 void tda7439SetMute(void)
 {
 	if (aproc.mute) {
-		I2CStart(TDA7439_I2C_ADDR);
-		I2CWriteByte(TDA7439_VOLUME_RIGHT | TDA7439_AUTO_INC);
-		I2CWriteByte(TDA7439_SPEAKER_MUTE);
-		I2CWriteByte(TDA7439_SPEAKER_MUTE);
-		I2CStop();
+		I2CQueueStart(TDA7439_I2C_ADDR);
+		I2CQueueByte(TDA7439_VOLUME_RIGHT | TDA7439_AUTO_INC);
+		I2CQueueByte(TDA7439_SPEAKER_MUTE);
+		I2CQueueByte(TDA7439_SPEAKER_MUTE);
+		I2CQueueEnd();
 	} else {
 		tda7439SetSpeakers();
 	}
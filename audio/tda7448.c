@@ -37,8 +37,8 @@ void tda7448SetSpeakers(void)
 	sp[TDA7448_CENTER] += sndPar[MODE_SND_CENTER].value;
 	sp[TDA7448_SUBWOOFER] += sndPar[MODE_SND_SUBWOOFER].value;
 
-	I2CStart(TDA7448_I2C_ADDR);
-	I2CWriteByte(TDA7448_AUTO_INC);
+	I2CQueueStart(TDA7448_I2C_ADDR);
+	I2CQueueByte(TDA7448_AUTO_INC);
 	for (i = 0; i < TDA7448_END; i++) {
 		/* Limit values sent to bus */
 		if (sp[i] < volMin)
@@ -47,9 +47,9 @@ void tda7448SetSpeakers(void)
 		/* Jump at -72db in raw data according the datasheet */
 		if (i2cData >= 72)
 			i2cData += 56;
-		I2CWriteByte(i2cData);
+		I2CQueueByte(i2cData);
 	}
-	I2CStop();
+	I2CQueueEnd();
 
 	return;
 }
@@ -59,11 +59,11 @@ void tda7448SetMute(void)
 	uint8_t i;
 
 	if (aproc.mute) {
-		I2CStart(TDA7448_I2C_ADDR);
-		I2CWriteByte(TDA7448_AUTO_INC);
+		I2CQueueStart(TDA7448_I2C_ADDR);
+		I2CQueueByte(TDA7448_AUTO_INC);
 		for (i = 0; i < TDA7448_END; i++)
-			I2CWriteByte(TDA7448_MUTE);
-		I2CStop();
+			I2CQueueByte(TDA7448_MUTE);
+		I2CQueueEnd();
 	} else {
 		tda7448SetSpeakers();
 	}
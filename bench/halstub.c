@@ -0,0 +1,32 @@
+/*
+ * Minimal host HAL for bench_host: register storage only, no timer
+ * thread and no EEPROM file, so nothing runs while stages are timed.
+ */
+
+#include "../host/hal.h"
+
+#include <avr/io.h>
+
+volatile uint8_t hostIoMem[HOST_IO_SIZE] __attribute__((aligned(2)));
+volatile uint8_t hostPinLow[HOST_PORT_END];
+
+void hostSei(void)
+{
+	SREG |= (1<<SREG_I);
+
+	return;
+}
+
+void hostCli(void)
+{
+	SREG &= ~(1<<SREG_I);
+
+	return;
+}
+
+void hostDelayUs(double us)
+{
+	(void)us;
+
+	return;
+}
@@ -0,0 +1,393 @@
+/*
+ * Spectrum pipeline benchmark: prepareData => fftRad4 => fftSplit => cplx2dB
+ *
+ * Built for AVR (run under simavr) with 'make bench' and natively
+ * with 'make bench_host'. Every stage is measured on the same stereo
+ * test signal, report is written as CSV lines prefixed with "spbench".
+ * CRC column is checksum of stage output to catch result changes.
+ */
+
+#include "../adc.c"
+
+#include <util/crc16.h>
+
+#ifdef __AVR__
+#include <avr/sleep.h>
+#else
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifdef __AVR__
+#define BENCH_RUNS			16				// simavr is cycle exact
+#else
+#define BENCH_RUNS			256				// Median hides scheduler noise
+#endif
+
+// Main loop is not linked, ADC interrupt events go nowhere
+void setEvent(uint16_t event)
+{
+	(void)event;
+
+	return;
+}
+
+enum {
+	STAGE_PREPARE = 0,
+	STAGE_FFT,
+	STAGE_SPLIT,
+	STAGE_DB,
+	STAGE_SPECTRUM,
+
+	STAGE_END
+};
+
+typedef struct {
+	uint32_t min;
+	uint32_t max;
+	uint32_t sum;
+	uint32_t run[BENCH_RUNS];
+	uint16_t crc;
+} BenchStage;
+
+static const char *stageName[STAGE_END] = {
+	"prepareData",
+	"fftRad4",
+	"fftSplit",
+	"cplx2dB",
+	"spectrum",
+};
+
+static BenchStage stage[STAGE_END];
+static uint8_t samples[2][FFT_SIZE];
+static uint32_t overhead;
+
+#ifdef __AVR__
+
+#define BENCH_UNIT			"cycles"
+
+static volatile uint16_t ovfCnt;
+
+ISR(TIMER1_OVF_vect)
+{
+	ovfCnt++;
+}
+
+static void benchInit(void)
+{
+	TCCR1A = 0;
+	TCCR1B = (1<<CS10);								// Count CPU cycles
+	TIMSK |= (1<<TOIE1);
+
+	UBRRL = 8;										// 115200 at 16MHz
+	UCSRB = (1<<TXEN);
+	UCSRC = (1<<URSEL) | (1<<UCSZ1) | (1<<UCSZ0);
+
+	sei();
+
+	return;
+}
+
+static uint32_t benchClock(void)
+{
+	uint16_t cnt, ovf;
+
+	cli();
+	cnt = TCNT1;
+	ovf = ovfCnt;
+	if ((TIFR & (1<<TOV1)) && cnt < 0x8000)
+		ovf++;
+	sei();
+
+	return ((uint32_t)ovf << 16) | cnt;
+}
+
+static void benchPutChar(char ch)
+{
+	while (!(UCSRA & (1<<UDRE)));
+	UDR = ch;
+
+	return;
+}
+
+static void benchDone(void)
+{
+	while (!(UCSRA & (1<<TXC)));
+
+	cli();											// simavr quits on sleep
+	sleep_enable();
+	sleep_cpu();
+
+	return;
+}
+
+#else
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define BENCH_UNIT			"tsc"
+
+static uint32_t benchClock(void)
+{
+	return __rdtsc();
+}
+
+#else
+
+#define BENCH_UNIT			"ns"
+
+static uint32_t benchClock(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+#endif
+
+static void benchInit(void)
+{
+	return;
+}
+
+static void benchPutChar(char ch)
+{
+	if (ch != '\r')
+		putchar(ch);
+
+	return;
+}
+
+static void benchDone(void)
+{
+	fflush(stdout);
+
+	return;
+}
+
+#endif
+
+static void benchPutString(const char *str)
+{
+	while (*str)
+		benchPutChar(*str++);
+
+	return;
+}
+
+static void benchPutNum(uint32_t num)
+{
+	char str[11];
+	uint8_t i = sizeof(str) - 1;
+
+	str[i] = '\0';
+	do {
+		str[--i] = '0' + num % 10;
+		num /= 10;
+	} while (num);
+
+	benchPutString(&str[i]);
+
+	return;
+}
+
+static void benchPutHex(uint16_t num)
+{
+	int8_t i;
+	uint8_t dig;
+
+	for (i = 12; i >= 0; i -= 4) {
+		dig = (num >> i) & 0x0F;
+		benchPutChar(dig < 10 ? '0' + dig : 'A' + dig - 10);
+	}
+
+	return;
+}
+
+static uint16_t benchCrc(uint16_t crc, const int16_t *data, uint8_t len)
+{
+	uint8_t i;
+
+	for (i = 0; i < len; i++) {
+		crc = _crc16_update(crc, data[i] & 0xFF);
+		crc = _crc16_update(crc, data[i] >> 8);
+	}
+
+	return crc;
+}
+
+static uint32_t benchAdd(uint8_t st, uint16_t run, uint32_t t0, uint32_t t1)
+{
+	BenchStage *s = &stage[st];
+	uint32_t cycles = t1 - t0;
+
+	cycles = cycles > overhead ? cycles - overhead : 0;
+
+	if (cycles < s->min)
+		s->min = cycles;
+	if (cycles > s->max)
+		s->max = cycles;
+	s->sum += cycles;
+	s->run[run] = cycles;
+
+	return cycles;
+}
+
+static uint32_t benchMedian(uint8_t st)
+{
+	uint32_t *r = stage[st].run;
+	uint32_t val;
+	uint16_t i, j;
+
+	for (i = 1; i < BENCH_RUNS; i++) {
+		val = r[i];
+		for (j = i; j && r[j - 1] > val; j--)
+			r[j] = r[j - 1];
+		r[j] = val;
+	}
+
+	return r[BENCH_RUNS / 2];
+}
+
+static void benchSignal(void)
+{
+	uint8_t i;
+	uint16_t rnd = 0xACE1;
+	int16_t val;
+
+	// Left: square wave at 1/8, triangle at 1/16 of sample rate plus noise
+	// Right: square wave at 1/4 of sample rate plus noise
+	for (i = 0; i < FFT_SIZE; i++) {
+		val = (i & 0x04) ? 40 : -40;
+		val += ((i & 0x0F) < 8 ? (i & 0x07) : 7 - (i & 0x07)) * 8 - 28;
+		rnd = (rnd >> 1) ^ (-(rnd & 1) & 0xB400);
+		val += (rnd & 0x0F) - 8;
+		samples[MUX_LEFT][i] = 128 + val;
+
+		val = (i & 0x02) ? 60 : -60;
+		val += ((rnd >> 4) & 0x1F) - 16;
+		samples[MUX_RIGHT][i] = 128 + val;
+	}
+
+	return;
+}
+
+static void benchLoad(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < FFT_SIZE; i++) {
+		adcBuf[0][i] = samples[MUX_LEFT][i];
+		adcBuf[1][i] = samples[MUX_RIGHT][i];
+	}
+	adcMux[0] = MUX_LEFT;
+	adcMux[1] = MUX_RIGHT;
+
+	return;
+}
+
+static void benchRun(void)
+{
+	uint8_t i;
+	uint16_t run;
+	uint32_t t0, t1, total;
+
+	for (i = 0; i < STAGE_END; i++) {
+		stage[i].min = UINT32_MAX;
+		stage[i].max = 0;
+		stage[i].sum = 0;
+		stage[i].crc = 0xFFFF;
+	}
+
+	t0 = benchClock();
+	t1 = benchClock();
+	overhead = t1 - t0;
+
+	for (run = 0; run < BENCH_RUNS; run++) {
+		benchLoad();
+
+		t0 = benchClock();
+		prepareData();
+		t1 = benchClock();
+		total = benchAdd(STAGE_PREPARE, run, t0, t1);
+		if (run == 0) {
+			stage[STAGE_PREPARE].crc = benchCrc(stage[STAGE_PREPARE].crc, fr, FFT_SIZE);
+			stage[STAGE_PREPARE].crc = benchCrc(stage[STAGE_PREPARE].crc, fi, FFT_SIZE);
+		}
+
+		t0 = benchClock();
+		fftRad4(fr, fi);
+		t1 = benchClock();
+		total += benchAdd(STAGE_FFT, run, t0, t1);
+		if (run == 0) {
+			stage[STAGE_FFT].crc = benchCrc(stage[STAGE_FFT].crc, fr, FFT_SIZE);
+			stage[STAGE_FFT].crc = benchCrc(stage[STAGE_FFT].crc, fi, FFT_SIZE);
+		}
+
+		t0 = benchClock();
+		fftSplit(fr, fi);
+		t1 = benchClock();
+		total += benchAdd(STAGE_SPLIT, run, t0, t1);
+		if (run == 0) {
+			stage[STAGE_SPLIT].crc = benchCrc(stage[STAGE_SPLIT].crc, fr, FFT_SIZE);
+			stage[STAGE_SPLIT].crc = benchCrc(stage[STAGE_SPLIT].crc, fi, FFT_SIZE);
+		}
+
+		t0 = benchClock();
+		cplx2dB(fr, fi);
+		t1 = benchClock();
+		total += benchAdd(STAGE_DB, run, t0, t1);
+		if (run == 0) {
+			stage[STAGE_DB].crc = benchCrc(stage[STAGE_DB].crc, fr, FFT_SIZE);
+			stage[STAGE_SPECTRUM].crc = stage[STAGE_DB].crc;
+		}
+
+		// Whole pipeline as getSpData() runs it for both channels
+		benchAdd(STAGE_SPECTRUM, run, 0, total + overhead);
+	}
+
+	return;
+}
+
+static void benchReport(void)
+{
+	uint8_t i;
+
+	benchPutString("spbench,stage,unit,runs,min,med,avg,max,crc\r\n");
+
+	for (i = 0; i < STAGE_END; i++) {
+		benchPutString("spbench,");
+		benchPutString(stageName[i]);
+		benchPutString("," BENCH_UNIT ",");
+		benchPutNum(BENCH_RUNS);
+		benchPutChar(',');
+		benchPutNum(stage[i].min);
+		benchPutChar(',');
+		benchPutNum(benchMedian(i));
+		benchPutChar(',');
+		benchPutNum(stage[i].sum / BENCH_RUNS);
+		benchPutChar(',');
+		benchPutNum(stage[i].max);
+		benchPutChar(',');
+		benchPutHex(stage[i].crc);
+		benchPutString("\r\n");
+	}
+
+	return;
+}
+
+int main(void)
+{
+	benchInit();
+	benchSignal();
+	benchRun();
+	benchReport();
+	benchDone();
+
+	return 0;
+}
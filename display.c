@@ -5,6 +5,7 @@
 
 #include "eeprom.h"
 #include "input.h"
+#include "timer.h"
 #include "tuner/tuner.h"
 #include "ds18x20.h"
 #include "temp.h"
@@ -150,6 +151,7 @@ const char STR_FM[]				PROGMEM = "FM ";
 const char STR_STEREO[]			PROGMEM = "ST";
 const char STR_MONO[]			PROGMEM = "MO";
 const char STR_TUNE[]			PROGMEM = "\xDB\xDB\xD0\xDC\xDC";
+const char STR_SCAN[]			PROGMEM = "SCAN ";
 const char STR_RDS[]			PROGMEM = "RDS";
 
 const char STR_YEAR20[]			PROGMEM = "20";
@@ -640,7 +642,7 @@ static void showParIcon(uint8_t icon)
 	uint8_t ic = icon;
 
 	if (ic >= MODE_SND_GAIN0 && ic < MODE_SND_END)
-		ic = eeprom_read_byte((uint8_t*)(EEPROM_INPUT_ICONS + (ic - MODE_SND_GAIN0)));
+		ic = eeprom_read_byte((uint8_t*)EEPROM_INPUT_ICONS + (ic - MODE_SND_GAIN0));
 	if (ic < ICON24_END)
 		icon = ic;
 
@@ -655,6 +657,31 @@ static void showParIcon(uint8_t icon)
 }
 #endif
 
+// Spectrum value of column x, 32 columns per channel
+static uint8_t spCol(const uint8_t *sp, uint8_t x)
+{
+#if SP_BINS > 32
+	x *= 2;
+	return sp[x] > sp[x + 1] ? sp[x] : sp[x + 1];
+#else
+	return sp[x * SP_BINS / 32];
+#endif
+}
+
+#ifndef KS0066
+// Spectrum value of half-column x, 64 half-columns per channel
+static uint8_t spHalfCol(const uint8_t *sp, uint8_t x)
+{
+#if SP_BINS >= 64
+	return sp[x];
+#else
+	if (x & 0x01)
+		return (spCol(sp, x / 2) + spCol(sp, x / 2 + 1)) / 2;
+	return spCol(sp, x / 2);
+#endif
+}
+#endif
+
 #ifdef KS0066
 #elif defined(LS020)
 static void drawSpCol(uint8_t xbase, uint8_t w, uint8_t btm, uint8_t val, uint8_t max)
@@ -679,7 +706,7 @@ static void drawBarSpectrum(void)
 	for (x = 0; x < 31; x++) {
 		xbase = x * 4 + 2;
 
-		ybase = (buf[x] + buf[x + 32]) / 2;
+		ybase = (spCol(buf, x) + spCol(buf + SP_BINS, x)) / 2;
 		drawSpCol(xbase, 2, 129, ybase, 31);
 		ls020DrawVertLine(xbase + 2, 129, 129 - 31, 0); // Clear space between bars
 	}
@@ -709,7 +736,7 @@ static void drawBarSpectrum(void)
 	for (x = 0; x < GD_SIZE_X / 4 - 1; x++) {
 		xbase = x * 3;
 
-		ybase = (buf[x] + buf[x + 32]) * 3 / 8;
+		ybase = (spCol(buf, x) + spCol(buf + SP_BINS, x)) * 3 / 8;
 		drawSpCol(xbase, 2, 63, ybase, 23);
 		gdDrawVertLine(xbase + 2, 63, 63 - 23, 0); // Clear space between bars
 	}
@@ -727,11 +754,11 @@ static void drawMiniSpectrum(void)
 
 	lcdGenBar (userAddSym);
 	data = 0;
-	for (i = 0; i < FFT_SIZE / 2; i++) {
+	for (i = 0; i < SP_BINS; i++) {
 		data += buf[i];
-		data += buf[FFT_SIZE / 2 + i];
+		data += buf[SP_BINS + i];
 	}
-	data >>= 5;
+	data /= SP_BINS;
 
 	ks0066SetXY(0, 1);
 	for (i = 0; i < KS0066_SCREEN_WIDTH; i++) {
@@ -752,7 +779,7 @@ static void drawMiniSpectrum(void)
 
 	for (x = 0; x < GD_SIZE_X / 4 - 1; x++) {
 		xbase = x * 3;
-		ybase = (buf[x] * 5 / 2 + buf[x + 32] * 5 / 2) / 4;
+		ybase = (spCol(buf, x) * 5 / 2 + spCol(buf + SP_BINS, x) * 5 / 2) / 4;
 		drawSpCol(xbase, 2, 63, ybase, 39);
 	}
 
@@ -763,7 +790,7 @@ static void drawMiniSpectrum(void)
 #ifdef KS0066
 static void drawTm(uint8_t tm)
 {
-	if (rtc.etm != tm || (getSecTimer() % 512) < 200) {
+	if (rtc.etm != tm || (timerLeft(TIMER_CLOCK) % 512) < 200) {
 		writeNum(*((int8_t*)&rtc + tm), 2, '0', 10);
 	} else {
 		writeString("  ");
@@ -787,7 +814,7 @@ static void drawTm(uint8_t tm, const uint8_t *font)
 #ifdef KS0066
 static void drawAm(uint8_t am)
 {
-	if (alarm0.eam != am || (getSecTimer() % 512) < 200) {
+	if (alarm0.eam != am || (timerLeft(TIMER_CLOCK) % 512) < 200) {
 		writeNum(*((int8_t*)&alarm0 + am), 2, '0', 10);
 	} else {
 		writeString("  ");
@@ -869,14 +896,8 @@ uint8_t getDefDisplay()
 
 void nextRcCmd(void)
 {
-	IRData irBuf = getIrData();
-
-	eeprom_update_byte((uint8_t*)EEPROM_RC_TYPE, irBuf.type);
-	eeprom_update_byte((uint8_t*)EEPROM_RC_ADDR, irBuf.address);
-	eeprom_update_byte((uint8_t*)EEPROM_RC_CMD + rcIndex, irBuf.command);
-
-	// Re-read new codes array from EEPROM
-	rcCodesInit();
+	// Store code to table of its remote and re-read codes
+	rcCodeStore(rcIndex, getIrData());
 
 	if (++rcIndex >= CMD_RC_END)
 		rcIndex = CMD_RC_STBY;
@@ -889,9 +910,7 @@ void nextRcCmd(void)
 void switchTestMode(uint8_t index)
 {
 	rcIndex = index;
-	setIrData(eeprom_read_byte((uint8_t*)EEPROM_RC_TYPE),
-			  eeprom_read_byte((uint8_t*)EEPROM_RC_ADDR),
-			  eeprom_read_byte((uint8_t*)EEPROM_RC_CMD + rcIndex));
+	rcCodeShow(rcIndex);
 
 	return;
 }
@@ -1120,12 +1139,15 @@ void showTemp(void)
 
 void showRadio(uint8_t tune)
 {
-	tunerReadStatus();
+	// Status is read by scan itself while it runs
+	uint8_t scan = tunerScanning();
+	if (!scan)
+		tunerReadStatus();
 
 	uint8_t i;
 
 	uint8_t level = tunerLevel();
-	uint8_t num = tunerStationNum();
+	uint8_t num = scan ? tunerScanFound() : tunerStationNum();
 	uint8_t favNum = tunerFavStationNum();
 #ifdef _RDS
 	uint8_t rdsFlag = rdsGetFlag();
@@ -1206,7 +1228,9 @@ void showRadio(uint8_t tune)
 
 	/* Tune status */
 	ks0066SetXY (12, 1);
-	if (tune == MODE_RADIO_TUNE) {
+	if (scan) {
+		writeString(">>");
+	} else if (tune == MODE_RADIO_TUNE) {
 		writeString("<>");
 	} else {
 		writeString("  ");
@@ -1277,7 +1301,10 @@ void showRadio(uint8_t tune)
 #endif
 
 	ls020LoadFont(font_ks0066_ru_08, COLOR_CYAN, 1);
-	if (tune == MODE_RADIO_TUNE) {
+	if (scan) {
+		ls020SetXY(148, 121);
+		writeStringPgm(STR_SCAN);
+	} else if (tune == MODE_RADIO_TUNE) {
 		ls020SetXY(148, 121);
 		writeStringPgm(STR_TUNE);
 	} else {
@@ -1353,7 +1380,10 @@ void showRadio(uint8_t tune)
 #endif
 
 	gdLoadFont(font_ks0066_ru_08, 1, FONT_DIR_0);
-	if (tune == MODE_RADIO_TUNE) {
+	if (scan) {
+		gdSetXY(103, 56);
+		writeStringPgm(STR_SCAN);
+	} else if (tune == MODE_RADIO_TUNE) {
 		gdSetXY(103, 56);
 		writeStringPgm(STR_TUNE);
 	} else {
@@ -1662,7 +1692,7 @@ void showAlarm(void)
 
 	/* Draw selected input */
 	ks0066SetXY(6, 0);
-	if (alarm0.eam != ALARM_INPUT || (getSecTimer() % 512) < 200)
+	if (alarm0.eam != ALARM_INPUT || (timerLeft(TIMER_CLOCK) % 512) < 200)
 		writeStringEeprom(txtLabels[MODE_SND_GAIN0 + i]);
 	/* Clear string tail */
 	ks0066WriteTail (' ', 15);
@@ -1670,7 +1700,7 @@ void showAlarm(void)
 	/* Draw weekdays */
 	lcdGenAlarm ();
 	ks0066SetXY(0, 1);
-	if (alarm0.eam != ALARM_WDAY || (getSecTimer() % 512) < 200) {
+	if (alarm0.eam != ALARM_WDAY || (timerLeft(TIMER_CLOCK) % 512) < 200) {
 		ks0066WriteData (0x04);
 	} else {
 		ks0066WriteData (0x03);
@@ -1684,7 +1714,7 @@ void showAlarm(void)
 		if (i != 6)
 			ks0066WriteData (0x02);
 	}
-	if (alarm0.eam != ALARM_WDAY || (getSecTimer() % 512) < 200) {
+	if (alarm0.eam != ALARM_WDAY || (timerLeft(TIMER_CLOCK) % 512) < 200) {
 		ks0066WriteData (0x06);
 	} else {
 		ks0066WriteData (0x05);
@@ -1834,10 +1864,9 @@ void showTimer(int16_t timer)
 	for (x = 0; x < LS020_HEIGHT / 6 + 1; x++) {
 		xbase = x * 6;
 
-		ybase = buf[x] + buf[x + 32];
+		ybase = spHalfCol(buf, 2 * x) + spHalfCol(buf + SP_BINS, 2 * x);
 		drawSpCol(xbase, 2, 131, 2 * ybase, 80);
-		ybase += buf[x + 1] + buf[x + 32 + 1];
-		ybase /= 2;
+		ybase = spHalfCol(buf, 2 * x + 1) + spHalfCol(buf + SP_BINS, 2 * x + 1);
 		drawSpCol(xbase + 3, 2, 131, 2 * ybase, 80);
 	}
 #else
@@ -1864,7 +1893,7 @@ void showTimer(int16_t timer)
 	for (x = 0; x < GD_SIZE_X / 4; x++) {
 		xbase = x << 2;
 
-		ybase = (buf[x] + buf[x + 32]) / 2;
+		ybase = (spCol(buf, x) + spCol(buf + SP_BINS, x)) / 2;
 		drawSpCol(xbase, 3, 63, ybase, 31);
 	}
 #endif
@@ -1908,14 +1937,14 @@ void showSpectrum(void)
 		lcdGenLevels();
 		ks0066SetXY(0, 0);
 		for (i = 0; i < KS0066_SCREEN_WIDTH; i++) {
-			data = buf[i] >> 2;
+			data = spCol(buf, i) >> 2;
 			if (data >= 7)
 				data = 0xFF;
 			ks0066WriteData(data);
 		}
 		ks0066SetXY(0, 1);
 		for (i = 0; i < KS0066_SCREEN_WIDTH; i++) {
-			data = buf[FFT_SIZE / 2 + i] >> 2;
+			data = spCol(buf + SP_BINS, i) >> 2;
 			if (data >= 7)
 				data = 0xFF;
 			ks0066WriteData(data);
@@ -1924,8 +1953,8 @@ void showSpectrum(void)
 	case SP_MODE_MIXED:
 		lcdGenLevels();
 		for (i = 0; i < KS0066_SCREEN_WIDTH; i++) {
-			data = buf[i];
-			data += buf[FFT_SIZE / 2 + i];
+			data = spCol(buf, i);
+			data += spCol(buf + SP_BINS, i);
 			data >>= 2;
 			ks0066SetXY(i, 0);
 			if (data < 8)
@@ -1945,12 +1974,12 @@ void showSpectrum(void)
 		lcdGenBar(userAddSym);
 		left = 0;
 		right = 0;
-		for (i = 0; i < FFT_SIZE / 2; i++) {
+		for (i = 0; i < SP_BINS; i++) {
 			left += buf[i];
-			right += buf[FFT_SIZE / 2 + i];
+			right += buf[SP_BINS + i];
 		}
-		left >>= 4;
-		right >>= 4;
+		left = left * 2 / SP_BINS;
+		right = right * 2 / SP_BINS;
 
 		ks0066SetXY(0, 0);
 		ks0066WriteData(eeprom_read_byte(txtLabels[LABEL_LEFT_CHANNEL]));
@@ -1990,16 +2019,14 @@ void showSpectrum(void)
 		for (x = 0; x < LS020_HEIGHT / 6 + 1; x++) {
 			xbase = x * 6;
 
-			ybase = buf[x];
+			ybase = spHalfCol(buf, 2 * x);
 			drawSpCol(xbase, 2, 65, 2 * ybase, 65);
-			ybase += buf[x + 1];
-			ybase /= 2;
+			ybase = spHalfCol(buf, 2 * x + 1);
 			drawSpCol(xbase + 3, 2, 65, 2 * ybase, 65);
 
-			ybase = buf[x + 32];
+			ybase = spHalfCol(buf + SP_BINS, 2 * x);
 			drawSpCol(xbase, 2, 131, 2 * ybase, 65);
-			ybase += buf[x + 32 + 1];
-			ybase /= 2;
+			ybase = spHalfCol(buf + SP_BINS, 2 * x + 1);
 			drawSpCol(xbase + 3, 2, 131, 2 * ybase, 65);
 		}
 		break;
@@ -2007,10 +2034,9 @@ void showSpectrum(void)
 		for (x = 0; x < LS020_HEIGHT / 6 + 1; x++) {
 			xbase = x * 6;
 
-			ybase = buf[x] + buf[x + 32];
+			ybase = spHalfCol(buf, 2 * x) + spHalfCol(buf + SP_BINS, 2 * x);
 			drawSpCol(xbase, 2, 131, 2 * ybase, 131);
-			ybase += buf[x + 1] + buf[x + 32 + 1];
-			ybase /= 2;
+			ybase = spHalfCol(buf, 2 * x + 1) + spHalfCol(buf + SP_BINS, 2 * x + 1);
 			drawSpCol(xbase + 3, 2, 131, 2 * ybase, 131);
 		}
 		break;
@@ -2022,12 +2048,12 @@ void showSpectrum(void)
 		writeStringEeprom(txtLabels[LABEL_RIGHT_CHANNEL]);
 		left = 0;
 		right = 0;
-		for (x = 0; x < 32; x++) {
+		for (x = 0; x < SP_BINS; x++) {
 			left += buf[x];
-			right += buf[x + 32];
+			right += buf[SP_BINS + x];
 		}
-		left >>= 3;
-		right >>= 3;
+		left = left * 4 / SP_BINS;
+		right = right * 4 / SP_BINS;
 
 		for (x = 0; x < 58; x++) {
 			ls020DrawRect(3 * x + 1, 20, 3 * x + 2, 29, x < left ? COLOR_YELLOW : COLOR_BLACK);
@@ -2051,10 +2077,9 @@ void showSpectrum(void)
 			xbase = x * 6;
 
 			for (y = 0; y < GD_SIZE_Y; y += 32) {
-				ybase = buf[x + y];
+				ybase = spHalfCol(&buf[y / 32 * SP_BINS], 2 * x);
 				drawSpCol(xbase, 2, 31 + y, ybase, 31);
-				ybase += buf[x + y + 1];
-				ybase /= 2;
+				ybase = spHalfCol(&buf[y / 32 * SP_BINS], 2 * x + 1);
 				drawSpCol(xbase + 3, 2, 31 + y, ybase, 31);
 			}
 		}
@@ -2063,10 +2088,9 @@ void showSpectrum(void)
 		for (x = 0; x < GD_SIZE_X / 6 + 1; x++) {
 			xbase = x * 6;
 
-			ybase = buf[x] + buf[x + 32];
+			ybase = spHalfCol(buf, 2 * x) + spHalfCol(buf + SP_BINS, 2 * x);
 			drawSpCol(xbase, 2, 63, ybase, 63);
-			ybase += buf[x + 1] + buf[x + 32 + 1];
-			ybase /= 2;
+			ybase = spHalfCol(buf, 2 * x + 1) + spHalfCol(buf + SP_BINS, 2 * x + 1);
 			drawSpCol(xbase + 3, 2, 63, ybase, 63);
 		}
 		break;
@@ -2078,12 +2102,12 @@ void showSpectrum(void)
 		writeStringEeprom(txtLabels[LABEL_RIGHT_CHANNEL]);
 		left = 0;
 		right = 0;
-		for (x = 0; x < GD_SIZE_X / 4; x++) {
+		for (x = 0; x < SP_BINS; x++) {
 			left += buf[x];
-			right += buf[x + 32];
+			right += buf[SP_BINS + x];
 		}
-		left >>= 4;
-		right >>= 4;
+		left = left * 2 / SP_BINS;
+		right = right * 2 / SP_BINS;
 
 		for (x = 0; x < 43; x++) {
 			for (y = 12; y < 27; y++) {
@@ -0,0 +1,186 @@
+#!/bin/sh
+
+# Generates display data bus write/read macros from pins.h wiring
+# Usage: dbus.sh <output header> <prefix>...
+#
+# For each prefix (KS0108, ST7920) D0..D7 lines are grouped by port, so
+# a byte is written with one read-modify-write per port. Bits that keep
+# their order inside a nibble are shifted, others go through a 16-entry
+# PROGMEM table (<prefix>_BUS_LUT). If D0..D7 are bits 0..7 of one port, it is a plain write.
+#
+# CPP may be set to the preprocessor command, default is "cpp".
+
+out=$1
+shift
+
+tmp=${out}.tmp.c
+{
+	echo '#include "pins.h"'
+	for p in "$@"; do
+		for i in 0 1 2 3 4 5 6 7; do
+			echo "DBUS_LINE ${p} ${i} ${p}_D${i} ${p}_D${i}_LINE"
+		done
+	done
+} > ${tmp}
+
+${CPP:-cpp} -P -I. ${tmp} | grep '^DBUS_LINE' | tr -d ' ()' | sed 's/^DBUS_LINE//' > ${tmp}.lines || exit 1
+
+# After removing spaces a line is like KS01080B1<<0, split it by known prefixes
+awk -v prefixes="$*" '
+BEGIN {
+	np = split(prefixes, pref, " ")
+	printf "/* Generated by dbus.sh from pins.h, do not edit */\n\n"
+	printf "#ifndef DBUS_H\n#define DBUS_H\n\n"
+	printf "#include <avr/pgmspace.h>\n\n"
+}
+
+function bitnum(expr,    v) {
+	if (expr ~ /^1<<[0-7]$/)
+		return substr(expr, 4) + 0
+	if (expr ~ /^0[xX]/) {
+		v = 0
+		expr = toupper(substr(expr, 3))
+		while (length(expr)) {
+			v = v * 16 + index("0123456789ABCDEF", substr(expr, 1, 1)) - 1
+			expr = substr(expr, 2)
+		}
+	} else {
+		v = expr + 0
+	}
+	for (b = 0; b < 8; b++)
+		if (v == 2 ^ b)
+			return b
+	return -1
+}
+
+function hex(v) {
+	return sprintf("0x%02X", v)
+}
+
+{
+	for (k = 1; k <= np; k++) {
+		p = pref[k]
+		if (substr($0, 1, length(p)) == p)
+			break
+	}
+	rest = substr($0, length(p) + 1)
+	d = substr(rest, 1, 1) + 0
+	port[p, d] = substr(rest, 2, 1)
+	bit[p, d] = bitnum(substr(rest, 3))
+	if (port[p, d] !~ /^[A-D]$/ || bit[p, d] < 0) {
+		printf "dbus.sh: can not parse %s_D%d wiring\n", p, d > "/dev/stderr"
+		err = 1
+		exit 1
+	}
+}
+
+# Port bits for one nibble of data, as expression of (data)
+function nibble(p, P, lo,    d, s, n, v, i, mask, shift, same) {
+	mask = 0
+	same = 1
+	shift = ""
+	for (d = lo; d < lo + 4; d++) {
+		if (port[p, d] != P)
+			continue
+		mask += 2 ^ bit[p, d]
+		s = bit[p, d] - d
+		if (shift == "")
+			shift = s
+		else if (shift != s)
+			same = 0
+	}
+	if (!mask)
+		return ""
+	if (same) {
+		if (shift > 0)
+			return sprintf("(((data) << %d) & %s)", shift, hex(mask))
+		if (shift < 0)
+			return sprintf("(((data) >> %d) & %s)", -shift, hex(mask))
+		return sprintf("((data) & %s)", hex(mask))
+	}
+	# Table of 16 port values for this nibble
+	for (n = 0; n < 16; n++) {
+		v = 0
+		for (i = 0; i < 4; i++)
+			if (port[p, lo + i] == P && int(n / 2 ^ i) % 2)
+				v += 2 ^ bit[p, lo + i]
+		lut = lut sprintf(" %s,", hex(v))
+	}
+	lutLen += 16
+	if (lo)
+		return sprintf("pgm_read_byte(&(lut)[%d + ((data) >> 4)])", lutLen - 16)
+	return sprintf("pgm_read_byte(&(lut)[%d + ((data) & 0x0F)])", lutLen - 16)
+}
+
+END {
+	if (err)
+		exit 1
+	for (k = 1; k <= np; k++) {
+		p = pref[k]
+		direct = 1
+		nports = 0
+		for (d = 0; d < 8; d++) {
+			if (port[p, d] != port[p, 0] || bit[p, d] != d)
+				direct = 0
+			if (!((p, port[p, d]) in pmask)) {
+				plist[++nports] = port[p, d]
+				pmask[p, port[p, d]] = 0
+			}
+			pmask[p, port[p, d]] += 2 ^ bit[p, d]
+		}
+
+		printf "/* %s D0..D7:", p
+		for (d = 0; d < 8; d++)
+			printf " P%s%d", port[p, d], bit[p, d]
+		printf " */\n"
+
+		if (direct) {
+			printf "#define %s_BUS_DIRECT\n", p
+			printf "#define %s_BUS_WRITE(lut, data)\tPORT%s = (data)\n", p, port[p, 0]
+			printf "#define %s_BUS_READ()\t\t\tPIN%s\n", p, port[p, 0]
+			printf "#define %s_BUS_DDR_OUT()\t\tDDR%s = 0xFF\n", p, port[p, 0]
+			printf "#define %s_BUS_DDR_IN()\t\tDDR%s = 0x00\n\n", p, port[p, 0]
+			continue
+		}
+
+		lut = ""
+		lutLen = 0
+		wr = ""
+		rd = ""
+		ddrOut = ""
+		ddrIn = ""
+		for (i = 1; i <= nports; i++) {
+			P = plist[i]
+			m = pmask[p, P]
+			lo = nibble(p, P, 0)
+			hi = nibble(p, P, 4)
+			val = lo (lo != "" && hi != "" ? " | " : "") hi
+			if (m == 255)
+				wr = wr sprintf("\t\tPORT%s = %s; \\\n", P, val)
+			else
+				wr = wr sprintf("\t\tPORT%s = (PORT%s & %s) | %s; \\\n", P, P, hex(255 - m), val)
+			ddrOut = ddrOut sprintf(" DDR%s |= %s;", P, hex(m))
+			ddrIn = ddrIn sprintf(" DDR%s &= %s;", P, hex(255 - m))
+		}
+		for (d = 0; d < 8; d++)
+			rd = rd sprintf("%s(PIN%s & %s ? %s : 0)", d ? " | " : "", port[p, d], hex(2 ^ bit[p, d]), hex(2 ^ d))
+
+		if (lutLen)
+			printf "#define %s_BUS_LUT {%s }\n", p, substr(lut, 1, length(lut) - 1)
+		printf "#define %s_BUS_WRITE(lut, data) \\\n\tdo { \\\n%s\t} while (0)\n", p, wr
+		printf "#define %s_BUS_READ()\t\t\t(%s)\n", p, rd
+		printf "#define %s_BUS_DDR_OUT()\t\tdo {%s } while (0)\n", p, ddrOut
+		printf "#define %s_BUS_DDR_IN()\t\tdo {%s } while (0)\n\n", p, ddrIn
+	}
+	printf "#endif /* DBUS_H */\n"
+}
+' ${tmp}.lines > ${out}.tmp
+ret=$?
+rm -f ${tmp} ${tmp}.lines
+
+if [ ${ret} -ne 0 ]; then
+	rm -f ${out}.tmp
+	exit 1
+fi
+
+mv ${out}.tmp ${out}
@@ -0,0 +1,67 @@
+#!/bin/sh
+
+# Adds glyph offset table to font source, so char lookup needs no width sum
+# Usage: fontoft.sh <font source> <output source>
+#
+# Table is placed between char widths and font data: one little-endian
+# word per char, byte offset of its glyph from the start of font data.
+
+in=$1
+out=$2
+
+awk '
+function hex(str,    i, v) {
+	v = 0
+	for (i = 3; i <= length(str); i++)
+		v = v * 16 + index("0123456789ABCDEF", toupper(substr(str, i, 1))) - 1
+	return v
+}
+
+{
+	line = $0
+	gsub(/\/\*[^*]*\*\//, "", line)
+	while (match(line, /0[xX][0-9A-Fa-f]+/)) {
+		val[n++] = hex(substr(line, RSTART, RLENGTH))
+		line = substr(line, RSTART + RLENGTH)
+	}
+}
+
+/\/\* font data \*\// {
+	height = val[0]
+	ccnt = val[2] ? val[2] : 256
+	if (n < 5 + ccnt) {
+		print FILENAME ": char widths are incomplete" > "/dev/stderr"
+		err = 1
+		exit 1
+	}
+
+	print "\t/* char offsets, generated by fontoft.sh */"
+	oft = 0
+	for (i = 0; i < ccnt; i++) {
+		if (oft > 65535) {
+			print FILENAME ": font data exceeds 64K" > "/dev/stderr"
+			err = 1
+			exit 1
+		}
+		row = row sprintf("0x%02X, 0x%02X, ", oft % 256, int(oft / 256))
+		if (i % 8 == 7 || i == ccnt - 1) {
+			sub(/ $/, "", row)
+			print "\t" row
+			row = ""
+		}
+		oft += val[5 + i] * height
+	}
+	print ""
+	done = 1
+}
+
+{ print }
+
+END {
+	if (!done && !err) {
+		print FILENAME ": no font data marker" > "/dev/stderr"
+		exit 1
+	}
+}' ${in} > ${out}.tmp || { rm -f ${out}.tmp; exit 1; }
+
+mv ${out}.tmp ${out}
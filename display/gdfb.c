@@ -19,8 +19,16 @@ void gdDrawHorizLine(uint8_t x1, uint8_t x2, uint8_t y, uint8_t color)
 		x2 = i;
 	}
 
-	for (i = x1; i <= x2; i++)
-		gdDrawPixel(i, y, color);
+	color = color ? 0xFF : 0x00;
+
+	// Up to 8 pixels per write
+	for (i = x1; ; i += 8) {
+		if (x2 - i < 8) {
+			gdDrawHorizBits(i, y, color, 0xFF << (7 - (x2 - i)));
+			break;
+		}
+		gdDrawHorizBits(i, y, color, 0xFF);
+	}
 
 	return;
 }
@@ -36,8 +44,16 @@ void gdDrawVertLine(uint8_t x, uint8_t y1, uint8_t y2, uint8_t color)
 		y2 = i;
 	}
 
-	for (i = y1; i <= y2; i++)
-		gdDrawPixel(x, i, color);
+	color = color ? 0xFF : 0x00;
+
+	// Up to 8 pixels per write
+	for (i = y1; ; i += 8) {
+		if (y2 - i < 8) {
+			gdDrawVertBits(x, i, color, 0xFF >> (7 - (y2 - i)));
+			break;
+		}
+		gdDrawVertBits(x, i, color, 0xFF);
+	}
 
 	return;
 }
@@ -56,8 +72,14 @@ void gdDrawFilledRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color)
 {
 	uint8_t i;
 
+	// Lines along framebuffer bytes are the fastest
+#ifdef GD_FB_VERTICAL
+	for (i = 0; i < w; i++)
+		gdDrawVertLine(x + i, y, y + h - 1, color);
+#else
 	for (i = 0; i < h; i++)
 		gdDrawHorizLine(x, x + w - 1, y + i, color);
+#endif
 
 	return;
 }
@@ -185,20 +207,19 @@ void gdWriteChar(uint8_t code)
 
 	uint8_t spos = code - ((code >= 128) ? fp[FONT_OFTNA] : fp[FONT_OFTA]);
 
-	uint16_t oft = 0;				// Current symbol offset in array
-	uint8_t swd = 0;				// Current symbol width
+	const uint8_t *pOft = _font + fp[FONT_CCNT] + 2 * spos;	// Glyph offset table entry
+
+	uint16_t oft;					// Current symbol offset in array
+	uint8_t swd;					// Current symbol width
 	uint8_t fwd = fp[FONT_FIXED];	// Fixed width
 
-	for (i = 0; i < spos; i++) {
-		swd = pgm_read_byte(_font + i);
-		oft += swd;
-	}
 	swd = pgm_read_byte(_font + spos);
 	if (!fwd)
 		fwd = swd;
 
-	oft *= fp[FONT_HEIGHT];
-	oft += fp[FONT_CCNT];
+	// Skip widths and offset table to glyph data
+	oft = pgm_read_byte(pOft) | (pgm_read_byte(pOft + 1) << 8);
+	oft += 3 * fp[FONT_CCNT];
 
 	for (j = 0; j < fp[FONT_HEIGHT]; j++) {
 		for (i = 0; i < fwd; i++) {
@@ -208,11 +229,12 @@ void gdWriteChar(uint8_t code)
 				pgmData = pgm_read_byte(_font + oft + (swd * j) + i);
 			if (!fp[FONT_COLOR])
 				pgmData = ~pgmData;
+			if (fp[FONT_DIRECTION] == FONT_DIR_0) {
+				gdDrawVertBits(_x + i, _y + 8 * j, pgmData, 0xFF);
+				continue;
+			}
 			for (k = 0; k < 8; k++) {
 				switch (fp[FONT_DIRECTION]) {
-				case FONT_DIR_0:
-					gdDrawPixel(_x + i, _y + (8 * j + k), pgmData & (1<<k));
-					break;
 				case FONT_DIR_90:
 					gdDrawPixel(_x + (8 * j + k), _y - i, pgmData & (1<<k));
 					break;
@@ -259,7 +281,7 @@ void gdWriteString(char *string)
 
 void gdWriteIcon24(uint8_t iconNum)
 {
-	uint8_t i, j, k;
+	uint8_t i, j;
 	uint8_t pgmData;
 
 	const uint8_t *icon;
@@ -270,9 +292,7 @@ void gdWriteIcon24(uint8_t iconNum)
 		for (j = 0; j < 3; j++) {
 			for (i = 0; i < 24; i++) {
 				pgmData = pgm_read_byte(icon + 24 * j + i);
-				for (k = 0; k < 8; k++) {
-					gdDrawPixel(_x + i, _y + 8 * j + k, pgmData & (1<<k));
-				}
+				gdDrawVertBits(_x + i, _y + 8 * j, pgmData, 0xFF);
 			}
 		}
 	}
@@ -282,7 +302,7 @@ void gdWriteIcon24(uint8_t iconNum)
 
 void gdWriteIcon32(uint8_t iconNum)
 {
-	uint8_t i, j, k;
+	uint8_t i, j;
 	uint8_t pgmData;
 
 	const uint8_t *icon;
@@ -293,9 +313,7 @@ void gdWriteIcon32(uint8_t iconNum)
 		for (j = 0; j < 4; j++) {
 			for (i = 0; i < 32; i++) {
 				pgmData = pgm_read_byte(icon + 32 * j + i);
-				for (k = 0; k < 8; k++) {
-					gdDrawPixel(_x + i, _y + 8 * j + k, pgmData & (1<<k));
-				}
+				gdDrawVertBits(_x + i, _y + 8 * j, pgmData, 0xFF);
 			}
 		}
 	}
@@ -37,6 +37,11 @@ enum {
 	FONT_DIR_270
 };
 
+/*
+ * gdDrawVertBits:  bit 0..7 => pixels (x, y)..(x, y + 7)
+ * gdDrawHorizBits: bit 7..0 => pixels (x, y)..(x + 7, y)
+ * Only pixels with bit set in mask are changed
+ */
 #if defined(ST7920)
 #define GD_MIN_BRIGHTNESS			ST7920_MIN_BRIGHTNESS
 #define GD_MAX_BRIGHTNESS			ST7920_MAX_BRIGHTNESS
@@ -46,6 +51,8 @@ enum {
 #define	gdClear()					st7920Clear()
 #define gdSetBrightness(br)			st7920SetBrightness(br)
 #define gdDrawPixel(x, y, color)	st7920DrawPixel(x, y, color)
+#define gdDrawVertBits(x, y, b, m)	st7920DrawVertBits(x, y, b, m)
+#define gdDrawHorizBits(x, y, b, m)	st7920DrawHorizBits(x, y, b, m)
 #define gdGetPins()					st7920GetPins()
 #elif defined(SSD1306)
 #define GD_MIN_BRIGHTNESS			SSD1306_MIN_BRIGHTNESS
@@ -56,7 +63,10 @@ enum {
 #define	gdClear()					ssd1306Clear()
 #define gdSetBrightness(br)			ssd1306SetBrightness(br)
 #define gdDrawPixel(x, y, color)	ssd1306DrawPixel(x, y, color)
+#define gdDrawVertBits(x, y, b, m)	ssd1306DrawVertBits(x, y, b, m)
+#define gdDrawHorizBits(x, y, b, m)	ssd1306DrawHorizBits(x, y, b, m)
 #define gdGetPins()					ssd1306GetPins()
+#define GD_FB_VERTICAL								// Framebuffer byte is 8 pixels column
 #else
 #define GD_MIN_BRIGHTNESS			KS0108_MIN_BRIGHTNESS
 #define GD_MAX_BRIGHTNESS			KS0108_MAX_BRIGHTNESS
@@ -66,7 +76,10 @@ enum {
 #define gdClear()					ks0108Clear()
 #define gdSetBrightness(br)			ks0108SetBrightness(br)
 #define gdDrawPixel(x, y, color)	ks0108DrawPixel(x, y, color)
+#define gdDrawVertBits(x, y, b, m)	ks0108DrawVertBits(x, y, b, m)
+#define gdDrawHorizBits(x, y, b, m)	ks0108DrawHorizBits(x, y, b, m)
 #define gdGetPins()					ks0108GetPins()
+#define GD_FB_VERTICAL								// Framebuffer byte is 8 pixels column
 #endif
 
 void gdDrawHorizLine(uint8_t x1, uint8_t x2, uint8_t y, uint8_t color);
@@ -4,6 +4,7 @@
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
 #include "../pins.h"
+#include "dbus.h"
 
 static volatile uint8_t pins;
 
@@ -24,6 +25,7 @@ static volatile uint8_t pins;
 #endif
 
 static uint8_t fb[KS0108_COLS * KS0108_CHIPS][KS0108_ROWS];
+static volatile uint8_t dirty[KS0108_CHIPS];		// Pages changed since refresh, bit per page
 static uint8_t _br;
 
 void ks0108SetBrightness(uint8_t br)
@@ -33,62 +35,34 @@ void ks0108SetBrightness(uint8_t br)
 	return;
 }
 
+#ifdef KS0108_BUS_LUT
+static const uint8_t busLut[] PROGMEM = KS0108_BUS_LUT;
+#endif
+
 static void ks0108SetPort(uint8_t data)
 {
-	if (data & (1<<0)) PORT(KS0108_D0) |= KS0108_D0_LINE; else PORT(KS0108_D0) &= ~KS0108_D0_LINE;
-	if (data & (1<<1)) PORT(KS0108_D1) |= KS0108_D1_LINE; else PORT(KS0108_D1) &= ~KS0108_D1_LINE;
-	if (data & (1<<2)) PORT(KS0108_D2) |= KS0108_D2_LINE; else PORT(KS0108_D2) &= ~KS0108_D2_LINE;
-	if (data & (1<<3)) PORT(KS0108_D3) |= KS0108_D3_LINE; else PORT(KS0108_D3) &= ~KS0108_D3_LINE;
-	if (data & (1<<4)) PORT(KS0108_D4) |= KS0108_D4_LINE; else PORT(KS0108_D4) &= ~KS0108_D4_LINE;
-	if (data & (1<<5)) PORT(KS0108_D5) |= KS0108_D5_LINE; else PORT(KS0108_D5) &= ~KS0108_D5_LINE;
-	if (data & (1<<6)) PORT(KS0108_D6) |= KS0108_D6_LINE; else PORT(KS0108_D6) &= ~KS0108_D6_LINE;
-	if (data & (1<<7)) PORT(KS0108_D7) |= KS0108_D7_LINE; else PORT(KS0108_D7) &= ~KS0108_D7_LINE;
+	KS0108_BUS_WRITE(busLut, data);
 
 	return;
 }
 
 static void ks0108SetDdrIn(void)
 {
-	DDR(KS0108_D0) &= ~KS0108_D0_LINE;
-	DDR(KS0108_D1) &= ~KS0108_D1_LINE;
-	DDR(KS0108_D2) &= ~KS0108_D2_LINE;
-	DDR(KS0108_D3) &= ~KS0108_D3_LINE;
-	DDR(KS0108_D4) &= ~KS0108_D4_LINE;
-	DDR(KS0108_D5) &= ~KS0108_D5_LINE;
-	DDR(KS0108_D6) &= ~KS0108_D6_LINE;
-	DDR(KS0108_D7) &= ~KS0108_D7_LINE;
+	KS0108_BUS_DDR_IN();
 
 	return;
 }
 
 static void ks0108SetDdrOut(void)
 {
-	DDR(KS0108_D0) |= KS0108_D0_LINE;
-	DDR(KS0108_D1) |= KS0108_D1_LINE;
-	DDR(KS0108_D2) |= KS0108_D2_LINE;
-	DDR(KS0108_D3) |= KS0108_D3_LINE;
-	DDR(KS0108_D4) |= KS0108_D4_LINE;
-	DDR(KS0108_D5) |= KS0108_D5_LINE;
-	DDR(KS0108_D6) |= KS0108_D6_LINE;
-	DDR(KS0108_D7) |= KS0108_D7_LINE;
+	KS0108_BUS_DDR_OUT();
 
 	return;
 }
 
 static uint8_t ks0108ReadPin(void)
 {
-	uint8_t ret = 0;
-
-	if (PIN(KS0108_D0) & KS0108_D0_LINE) ret |= (1<<0);
-	if (PIN(KS0108_D1) & KS0108_D1_LINE) ret |= (1<<1);
-	if (PIN(KS0108_D2) & KS0108_D2_LINE) ret |= (1<<2);
-	if (PIN(KS0108_D3) & KS0108_D3_LINE) ret |= (1<<3);
-	if (PIN(KS0108_D4) & KS0108_D4_LINE) ret |= (1<<4);
-	if (PIN(KS0108_D5) & KS0108_D5_LINE) ret |= (1<<5);
-	if (PIN(KS0108_D6) & KS0108_D6_LINE) ret |= (1<<6);
-	if (PIN(KS0108_D7) & KS0108_D7_LINE) ret |= (1<<7);
-
-	return ret;
+	return KS0108_BUS_READ();
 }
 
 static void ks0108WriteCmd(uint8_t cmd)
@@ -116,16 +90,31 @@ ISR (TIMER0_OVF_vect)
 	run = !run;
 
 	static uint8_t i;
-	static uint8_t j;
+	static uint8_t j = KS0108_PHASE_SET_PAGE;
 	static uint8_t cs;
+	static uint8_t bit = 1;							// Current page mask, 1 << i
+	static uint8_t upd;								// Page is being sent
 
 	static uint8_t br;
 
+	uint8_t k, pages;
+
 	if (j == KS0108_PHASE_SET_PAGE) {				// Phase 1 (Y)
-		if (++i >= 8) {
-			i = 0;
+		// Go to next changed page, only read pins if nothing changed
+		upd = 0;
+		pages = dirty[cs] & (uint8_t)~((bit << 1) - 1);	// Pages after current one
+		for (k = 0; !pages && k < KS0108_CHIPS; k++) {	// Skip chips without changes
 			if (++cs >= KS0108_CHIPS)
 				cs = 0;
+			pages = dirty[cs];
+		}
+		if (pages) {
+			for (i = 0, bit = 1; !(pages & bit); i++)
+				bit <<= 1;
+			dirty[cs] &= ~bit;
+			upd = 1;
+		}
+		if (upd) {
 			switch (cs) {
 			case 1:
 				KS0108_SET_CS2();
@@ -134,9 +123,9 @@ ISR (TIMER0_OVF_vect)
 				KS0108_SET_CS1();
 				break;
 			}
+			PORT(KS0108_DI) &= ~KS0108_DI_LINE;		// Go to command mode
+			ks0108SetPort(KS0108_SET_PAGE + i);
 		}
-		PORT(KS0108_DI) &= ~KS0108_DI_LINE;			// Go to command mode
-		ks0108SetPort(KS0108_SET_PAGE + i);
 	} else if (j == KS0108_PHASE_SET_ADDR) {		// Phase 2 (X)
 		ks0108SetPort(KS0108_SET_ADDRESS);
 	} else if (j == KS0108_PHASE_READ_PORT) {
@@ -147,9 +136,11 @@ ISR (TIMER0_OVF_vect)
 	}
 
 	if (j != KS0108_PHASE_READ_PORT) {
-		PORT(KS0108_E) |= KS0108_E_LINE;			// Strob
-		asm("nop");
-		PORT(KS0108_E) &= ~KS0108_E_LINE;
+		if (upd) {
+			PORT(KS0108_E) |= KS0108_E_LINE;		// Strob
+			asm("nop");
+			PORT(KS0108_E) &= ~KS0108_E_LINE;
+		}
 
 		// Prepare to read pins
 		if (j == KS0108_PHASE_SET_ADDR) {
@@ -159,8 +150,12 @@ ISR (TIMER0_OVF_vect)
 	}
 
 	if (++j > KS0108_PHASE_READ_PORT) {
-		j = 0;
-		PORT(KS0108_DI) |= KS0108_DI_LINE;			// Go to data mode
+		if (upd) {
+			j = 0;
+			PORT(KS0108_DI) |= KS0108_DI_LINE;		// Go to data mode
+		} else {
+			j = KS0108_PHASE_SET_PAGE;
+		}
 	}
 
 	if (++br >= KS0108_MAX_BRIGHTNESS)				// Loop brightness
@@ -214,6 +209,10 @@ void ks0108Init(void)
 	// Enable backlight control
 	DDR(KS0108_BCKL) |= KS0108_BCKL_LINE;
 
+	// Send whole framebuffer once
+	dirty[0] = 0xFF;
+	dirty[1] = 0xFF;
+
 	return;
 }
 
@@ -227,6 +226,22 @@ void ks0108Clear(void)
 		}
 	}
 
+	for (i = 0; i < KS0108_CHIPS; i++)
+		dirty[i] = 0xFF;
+
+	return;
+}
+
+static void ks0108WriteFb(uint8_t x, uint8_t page, uint8_t bits, uint8_t mask)
+{
+	uint8_t *p = &fb[x][page];
+	uint8_t data = (*p & ~mask) | (bits & mask);
+
+	if (data != *p) {
+		*p = data;
+		dirty[x / KS0108_COLS] |= (1 << page);
+	}
+
 	return;
 }
 
@@ -241,10 +256,44 @@ void ks0108DrawPixel(uint8_t x, uint8_t y, uint8_t color)
 
 	bit = 1 << (y & 0x07);
 
-	if (color)
-		fb[x][y >> 3] |= bit;
-	else
-		fb[x][y >> 3] &= ~bit;
+	ks0108WriteFb(x, y >> 3, color ? bit : 0x00, bit);
+
+	return;
+}
+
+void ks0108DrawVertBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask)
+{
+	uint8_t page = y >> 3;
+	uint8_t sh = y & 0x07;
+
+	if (x >= KS0108_COLS * KS0108_CHIPS)
+		return;
+
+	// Bits are split between two pages if y is not aligned
+	if (page < KS0108_ROWS)
+		ks0108WriteFb(x, page, bits << sh, mask << sh);
+	if (sh && ++page < KS0108_ROWS)
+		ks0108WriteFb(x, page, bits >> (8 - sh), mask >> (8 - sh));
+
+	return;
+}
+
+void ks0108DrawHorizBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask)
+{
+	uint8_t bit;
+	uint8_t i;
+
+	if (y >= KS0108_ROWS * 8)
+		return;
+
+	bit = 1 << (y & 0x07);
+
+	for (i = 0; i < 8 && x < KS0108_COLS * KS0108_CHIPS; i++, x++) {
+		if (mask & 0x80)
+			ks0108WriteFb(x, y >> 3, (bits & 0x80) ? bit : 0x00, bit);
+		bits <<= 1;
+		mask <<= 1;
+	}
 
 	return;
 }
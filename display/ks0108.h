@@ -38,6 +38,8 @@ void ks0108Init(void);
 void ks0108Clear(void);
 
 void ks0108DrawPixel(uint8_t x, uint8_t y, uint8_t color);
+void ks0108DrawVertBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask);
+void ks0108DrawHorizBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask);
 
 uint8_t ks0108GetPins(void);
 
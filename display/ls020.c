@@ -277,17 +277,16 @@ void ls020WriteChar(uint8_t code)
 
 	uint8_t spos = code - ((code >= 128) ? fp[FONT_OFTNA] : fp[FONT_OFTA]);
 
-	uint16_t oft = 0;	/* Current symbol offset in array*/
-	uint8_t swd = 0;	/* Current symbol width */
+	const uint8_t *pOft = _font + fp[FONT_CCNT] + 2 * spos;	/* Glyph offset table entry */
+
+	uint16_t oft;		/* Current symbol offset in array*/
+	uint8_t swd;		/* Current symbol width */
 
-	for (i = 0; i < spos; i++) {
-		swd = pgm_read_byte(_font + i);
-		oft += swd;
-	}
 	swd = pgm_read_byte(_font + spos);
 
-	oft *= fp[FONT_HEIGHT];
-	oft += fp[FONT_CCNT];
+	/* Skip widths and offset table to glyph data */
+	oft = pgm_read_byte(pOft) | (pgm_read_byte(pOft + 1) << 8);
+	oft += 3 * fp[FONT_CCNT];
 
 	ls020SetWindow(x, y, x + swd * fp[FONT_MULT] - 1, y + fp[FONT_HEIGHT] * fp[FONT_MULT] * 8 - 1);
 
@@ -6,7 +6,12 @@
 #include <avr/pgmspace.h>
 #include <util/delay.h>
 
+#ifdef SSD1306_TWI
+#include "../i2c.h"
+#endif
+
 static uint8_t fb[SSD1306_BUFFERSIZE];
+static uint8_t dirty = 0xFF;					// Pages changed since update, bit per page
 
 static const uint8_t initSeq[] PROGMEM = {
 	SSD1306_DISPLAY_OFF,
@@ -36,15 +41,23 @@ static const uint8_t initSeq[] PROGMEM = {
 	SSD1306_DISPLAY_ON,
 };
 
-static const uint8_t dispAreaSeq[] PROGMEM = {
+// Followed by start and end page
+static const uint8_t pageAreaSeq[] PROGMEM = {
 	SSD1306_COLUMNADDR,
 	0x00,
 	0x7F,
 	SSD1306_PAGEADDR,
-	0x00,
-	0x07,
 };
 
+#ifdef SSD1306_TWI
+
+// Init and contrast go over hardware TWI, framebuffer is queued
+#define _I2CWriteByte(data)			I2CWriteByte(data)
+#define _I2CStart(addr)				I2CStart(addr)
+#define _I2CStop()					I2CStop()
+
+#else
+
 static void _I2CWriteByte(uint8_t data)
 {
 	uint8_t i = 0;
@@ -97,6 +110,8 @@ static void _I2CStop(void)
 	return;
 }
 
+#endif
+
 static void ssd1306SendCmd(uint8_t cmd)
 {
 	_I2CWriteByte(cmd);
@@ -172,30 +187,82 @@ ISR (TIMER0_OVF_vect)
 	return;
 }
 
+#ifdef SSD1306_TWI
+
 void ssd1306UpdateFb(void)
 {
-	uint16_t i;
+	static uint8_t page;
+	uint8_t i, j;
+
+	// Queue changed pages while there is room, others go on next call
+	for (i = 0; i < SSD1306_PAGES && dirty; i++) {
+		if (!(dirty & (1 << page))) {
+			if (++page >= SSD1306_PAGES)
+				page = 0;
+			continue;
+		}
+		if (!I2CQueueFree(2 * (sizeof(pageAreaSeq) + 2) + 1))
+			break;
+		dirty &= ~(1 << page);
+
+		I2CQueueStart(SSD1306_I2C_ADDR);
+		I2CQueueFast();
+		for (j = 0; j < sizeof(pageAreaSeq); j++) {
+			I2CQueueByte(SSD1306_I2C_COMMAND_CO);
+			I2CQueueByte(pgm_read_byte(&pageAreaSeq[j]));
+		}
+		for (j = 0; j < 2; j++) {
+			I2CQueueByte(SSD1306_I2C_COMMAND_CO);
+			I2CQueueByte(page);
+		}
+		I2CQueueByte(SSD1306_I2C_DATA_SEQ);
+		I2CQueueData(&fb[page * SSD1306_WIDTH], SSD1306_WIDTH);
+		I2CQueueEnd();
+
+		if (++page >= SSD1306_PAGES)
+			page = 0;
+	}
+
+	return;
+}
+
+#else
+
+void ssd1306UpdateFb(void)
+{
+	uint8_t i;
+	uint8_t page;
 	uint8_t *fbP = fb;
 
-	_I2CStart(SSD1306_I2C_ADDR);
-	_I2CWriteByte(SSD1306_I2C_COMMAND);
+	for (page = 0; page < SSD1306_PAGES; page++, fbP += SSD1306_WIDTH) {
+		if (!(dirty & (1 << page)))
+			continue;
+		dirty &= ~(1 << page);
 
-	for (i = 0; i < sizeof(dispAreaSeq); i++)
-		ssd1306SendCmd(pgm_read_byte(&dispAreaSeq[i]));
+		_I2CStart(SSD1306_I2C_ADDR);
+		_I2CWriteByte(SSD1306_I2C_COMMAND);
 
-	_I2CStop();
+		for (i = 0; i < sizeof(pageAreaSeq); i++)
+			ssd1306SendCmd(pgm_read_byte(&pageAreaSeq[i]));
+		ssd1306SendCmd(page);
+		ssd1306SendCmd(page);
 
-	_I2CStart(SSD1306_I2C_ADDR);
-	_I2CWriteByte(SSD1306_I2C_DATA_SEQ);
+		_I2CStop();
 
-	for (i = 0; i < SSD1306_BUFFERSIZE; i++)
-		_I2CWriteByte(*fbP++);
+		_I2CStart(SSD1306_I2C_ADDR);
+		_I2CWriteByte(SSD1306_I2C_DATA_SEQ);
 
-	_I2CStop();
+		for (i = 0; i < SSD1306_WIDTH; i++)
+			_I2CWriteByte(fbP[i]);
+
+		_I2CStop();
+	}
 
 	return;
 }
 
+#endif
+
 void ssd1306DrawPixel(uint8_t x, uint8_t y, uint8_t color)
 {
 	uint8_t bit;
@@ -214,6 +281,61 @@ void ssd1306DrawPixel(uint8_t x, uint8_t y, uint8_t color)
 		*fbP |= bit;
 	else
 		*fbP &= ~bit;
+	dirty |= 1 << (y >> 3);
+
+	return;
+}
+
+void ssd1306DrawVertBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask)
+{
+	uint8_t sh = y & 0x07;
+	uint8_t *fbP;
+
+	if (x >= 128)
+		return;
+	if (y >= 64)
+		return;
+
+	fbP = &fb[(y >> 3) * 128 + x];
+
+	// Bits are split between two pages if y is not aligned
+	*fbP = (*fbP & ~(mask << sh)) | ((bits & mask) << sh);
+	dirty |= 1 << (y >> 3);
+	if (sh && (y += 8) < 64) {
+		fbP += 128;
+		*fbP = (*fbP & ~(mask >> (8 - sh))) | ((bits & mask) >> (8 - sh));
+		dirty |= 1 << (y >> 3);
+	}
+
+	return;
+}
+
+void ssd1306DrawHorizBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask)
+{
+	uint8_t bit;
+	uint8_t i;
+	uint8_t *fbP;
+
+	if (x >= 128)
+		return;
+	if (y >= 64)
+		return;
+
+	fbP = &fb[(y >> 3) * 128 + x];
+
+	bit = 1 << (y & 0x07);
+	dirty |= 1 << (y >> 3);
+
+	for (i = 0; i < 8 && x < 128; i++, x++, fbP++) {
+		if (mask & 0x80) {
+			if (bits & 0x80)
+				*fbP |= bit;
+			else
+				*fbP &= ~bit;
+		}
+		bits <<= 1;
+		mask <<= 1;
+	}
 
 	return;
 }
@@ -225,6 +347,7 @@ void ssd1306Clear(void)
 
 	for (i = 0; i < SSD1306_BUFFERSIZE; i++)
 		*fbP++ = 0x00;
+	dirty = 0xFF;
 
 	return;
 }
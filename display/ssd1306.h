@@ -6,6 +6,7 @@
 #define SSD1306_I2C_ADDR				0x78
 
 #define SSD1306_I2C_COMMAND				0x00
+#define SSD1306_I2C_COMMAND_CO			0x80 // Single command, control byte follows
 #define SSD1306_I2C_DATA_SEQ			0x40
 
 // Fundamental commands
@@ -103,6 +104,7 @@
 #define SSD1306_WIDTH					128
 #define SSD1306_HEIGHT					64
 #define SSD1306_BUFFERSIZE				(SSD1306_WIDTH * SSD1306_HEIGHT / 8)
+#define SSD1306_PAGES					(SSD1306_HEIGHT / 8)
 
 #define SSD1306_MIN_BRIGHTNESS			0
 #define SSD1306_MAX_BRIGHTNESS			32
@@ -113,6 +115,8 @@ void ssd1306UpdateFb(void);
 
 void ssd1306Init(void);
 void ssd1306DrawPixel(uint8_t x, uint8_t y, uint8_t color);
+void ssd1306DrawVertBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask);
+void ssd1306DrawHorizBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask);
 void ssd1306Clear(void);
 
 void ssd1306SetBrightness(uint8_t br);
@@ -4,10 +4,12 @@
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
 #include "../pins.h"
+#include "dbus.h"
 
 static volatile uint8_t pins;
 
 static uint8_t fb[ST7920_SIZE_X / 4][ST7920_SIZE_Y / 2];
+static volatile uint8_t dirty[ST7920_SIZE_Y / 2 / 8];		// Rows changed since refresh, bit per row
 static uint8_t _br;
 
 void st7920SetBrightness(uint8_t br)
@@ -17,62 +19,34 @@ void st7920SetBrightness(uint8_t br)
 	return;
 }
 
+#ifdef ST7920_BUS_LUT
+static const uint8_t busLut[] PROGMEM = ST7920_BUS_LUT;
+#endif
+
 static void st7920SetPort(uint8_t data)
 {
-	if (data & (1<<0)) PORT(ST7920_D0) |= ST7920_D0_LINE; else PORT(ST7920_D0) &= ~ST7920_D0_LINE;
-	if (data & (1<<1)) PORT(ST7920_D1) |= ST7920_D1_LINE; else PORT(ST7920_D1) &= ~ST7920_D1_LINE;
-	if (data & (1<<2)) PORT(ST7920_D2) |= ST7920_D2_LINE; else PORT(ST7920_D2) &= ~ST7920_D2_LINE;
-	if (data & (1<<3)) PORT(ST7920_D3) |= ST7920_D3_LINE; else PORT(ST7920_D3) &= ~ST7920_D3_LINE;
-	if (data & (1<<4)) PORT(ST7920_D4) |= ST7920_D4_LINE; else PORT(ST7920_D4) &= ~ST7920_D4_LINE;
-	if (data & (1<<5)) PORT(ST7920_D5) |= ST7920_D5_LINE; else PORT(ST7920_D5) &= ~ST7920_D5_LINE;
-	if (data & (1<<6)) PORT(ST7920_D6) |= ST7920_D6_LINE; else PORT(ST7920_D6) &= ~ST7920_D6_LINE;
-	if (data & (1<<7)) PORT(ST7920_D7) |= ST7920_D7_LINE; else PORT(ST7920_D7) &= ~ST7920_D7_LINE;
+	ST7920_BUS_WRITE(busLut, data);
 
 	return;
 }
 
 static void st7920SetDdrIn(void)
 {
-	DDR(ST7920_D0) &= ~ST7920_D0_LINE;
-	DDR(ST7920_D1) &= ~ST7920_D1_LINE;
-	DDR(ST7920_D2) &= ~ST7920_D2_LINE;
-	DDR(ST7920_D3) &= ~ST7920_D3_LINE;
-	DDR(ST7920_D4) &= ~ST7920_D4_LINE;
-	DDR(ST7920_D5) &= ~ST7920_D5_LINE;
-	DDR(ST7920_D6) &= ~ST7920_D6_LINE;
-	DDR(ST7920_D7) &= ~ST7920_D7_LINE;
+	ST7920_BUS_DDR_IN();
 
 	return;
 }
 
 static void st7920SetDdrOut(void)
 {
-	DDR(ST7920_D0) |= ST7920_D0_LINE;
-	DDR(ST7920_D1) |= ST7920_D1_LINE;
-	DDR(ST7920_D2) |= ST7920_D2_LINE;
-	DDR(ST7920_D3) |= ST7920_D3_LINE;
-	DDR(ST7920_D4) |= ST7920_D4_LINE;
-	DDR(ST7920_D5) |= ST7920_D5_LINE;
-	DDR(ST7920_D6) |= ST7920_D6_LINE;
-	DDR(ST7920_D7) |= ST7920_D7_LINE;
+	ST7920_BUS_DDR_OUT();
 
 	return;
 }
 
 static uint8_t st7920ReadPin(void)
 {
-	uint8_t ret = 0;
-
-	if (PIN(ST7920_D0) & ST7920_D0_LINE) ret |= (1<<0);
-	if (PIN(ST7920_D1) & ST7920_D1_LINE) ret |= (1<<1);
-	if (PIN(ST7920_D2) & ST7920_D2_LINE) ret |= (1<<2);
-	if (PIN(ST7920_D3) & ST7920_D3_LINE) ret |= (1<<3);
-	if (PIN(ST7920_D4) & ST7920_D4_LINE) ret |= (1<<4);
-	if (PIN(ST7920_D5) & ST7920_D5_LINE) ret |= (1<<5);
-	if (PIN(ST7920_D6) & ST7920_D6_LINE) ret |= (1<<6);
-	if (PIN(ST7920_D7) & ST7920_D7_LINE) ret |= (1<<7);
-
-	return ret;
+	return ST7920_BUS_READ();
 }
 
 static void st7920WriteCmd(uint8_t cmd)
@@ -101,14 +75,33 @@ ISR (TIMER0_OVF_vect)
 
 	static uint8_t i = 0;
 	static uint8_t j = 32;
+	static uint8_t bit = 1;									// Current row mask in dirty[i >> 3]
+	static uint8_t upd;										// Row is being sent
 
 	static uint8_t br;
 
+	uint8_t k, n, rows;
+
 	if (j == ST7920_PHASE_SET_PAGE) {						// Phase 1 (Y)
-		PORT(ST7920_RS) &= ~ST7920_RS_LINE;					// Go to command mode
-		if (++i >= ST7920_PHASE_SET_PAGE)
-			i = 0;
-		st7920SetPort(ST7920_SET_GRAPHIC_RAM | i);			// Set Y
+		// Go to next changed row, only read pins if nothing changed
+		upd = 0;
+		n = i >> 3;
+		rows = dirty[n] & (uint8_t)~((bit << 1) - 1);		// Rows after current one
+		for (k = 0; !rows && k < sizeof(dirty); k++) {		// Skip bytes without changes
+			if (++n >= sizeof(dirty))
+				n = 0;
+			rows = dirty[n];
+		}
+		if (rows) {
+			for (i = n << 3, bit = 1; !(rows & bit); i++)
+				bit <<= 1;
+			dirty[n] &= ~bit;
+			upd = 1;
+		}
+		if (upd) {
+			PORT(ST7920_RS) &= ~ST7920_RS_LINE;				// Go to command mode
+			st7920SetPort(ST7920_SET_GRAPHIC_RAM | i);		// Set Y
+		}
 	} else if (j == ST7920_PHASE_SET_ADDR) {				// Phase 2 (X)
 		st7920SetPort(ST7920_SET_GRAPHIC_RAM);				// Set X
 	} else if (j == ST7920_PHASE_READ_PORT) {
@@ -119,9 +112,11 @@ ISR (TIMER0_OVF_vect)
 	}
 
 	if (j != ST7920_PHASE_READ_PORT) {
-		PORT(ST7920_E) |= ST7920_E_LINE;					// Strob
-		asm("nop");
-		PORT(ST7920_E) &= ~ST7920_E_LINE;
+		if (upd) {
+			PORT(ST7920_E) |= ST7920_E_LINE;				// Strob
+			asm("nop");
+			PORT(ST7920_E) &= ~ST7920_E_LINE;
+		}
 
 		// Prepare to read pins
 		if (j == ST7920_PHASE_SET_ADDR) {
@@ -131,8 +126,12 @@ ISR (TIMER0_OVF_vect)
 	}
 
 	if (++j > ST7920_PHASE_READ_PORT) {
-		j = 0;
-		PORT(ST7920_RS) |= ST7920_RS_LINE;					// Go to data mode
+		if (upd) {
+			j = 0;
+			PORT(ST7920_RS) |= ST7920_RS_LINE;				// Go to data mode
+		} else {
+			j = ST7920_PHASE_SET_PAGE;
+		}
 	}
 
 	if (++br >= ST7920_MAX_BRIGHTNESS)						// Loop brightness
@@ -148,6 +147,8 @@ ISR (TIMER0_OVF_vect)
 
 void st7920Init(void)
 {
+	uint8_t i;
+
 	// Set control and data lines as outputs
 	DDR(ST7920_RW) |= ST7920_RW_LINE;
 	DDR(ST7920_RS) |= ST7920_RS_LINE;
@@ -175,6 +176,10 @@ void st7920Init(void)
 
 	DDR(ST7920_BCKL)  |= ST7920_BCKL_LINE;
 
+	// Send whole framebuffer once
+	for (i = 0; i < sizeof(dirty); i++)
+		dirty[i] = 0xFF;
+
 	return;
 }
 
@@ -188,6 +193,30 @@ void st7920Clear()
 		}
 	}
 
+	for (i = 0; i < sizeof(dirty); i++)
+		dirty[i] = 0xFF;
+
+	return;
+}
+
+static void st7920WriteFb(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask)
+{
+	uint8_t *p;
+	uint8_t data;
+
+	// Bottom half of screen is right half of GDRAM
+	if (y >= 32)
+		x += 128;
+	y &= 0x1F;
+
+	p = &fb[x >> 3][y];
+	data = (*p & ~mask) | (bits & mask);
+
+	if (data != *p) {
+		*p = data;
+		dirty[y >> 3] |= (1 << (y & 0x07));
+	}
+
 	return;
 }
 
@@ -202,13 +231,44 @@ void st7920DrawPixel(uint8_t x, uint8_t y, uint8_t color)
 
 	bit = 0x80 >> (x & 0x07);
 
-	if (y >= 32)
-		x += 128;
+	st7920WriteFb(x, y, color ? bit : 0x00, bit);
+
+	return;
+}
+
+void st7920DrawVertBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask)
+{
+	uint8_t bit;
+	uint8_t i;
+
+	if (x >= ST7920_SIZE_X)
+		return;
+
+	bit = 0x80 >> (x & 0x07);
+
+	for (i = 0; i < 8 && y < ST7920_SIZE_Y; i++, y++) {
+		if (mask & 0x01)
+			st7920WriteFb(x, y, (bits & 0x01) ? bit : 0x00, bit);
+		bits >>= 1;
+		mask >>= 1;
+	}
+
+	return;
+}
+
+void st7920DrawHorizBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask)
+{
+	uint8_t sh = x & 0x07;
+
+	if (x >= ST7920_SIZE_X)
+		return;
+	if (y >= ST7920_SIZE_Y)
+		return;
 
-	if (color)
-		fb[x >> 3][y & 0x1F] |= bit;
-	else
-		fb[x >> 3][y & 0x1F] &= ~bit;
+	// Bits are split between two bytes if x is not aligned
+	st7920WriteFb(x, y, bits >> sh, mask >> sh);
+	if (sh && (x += 8) < ST7920_SIZE_X)
+		st7920WriteFb(x, y, bits << (8 - sh), mask << (8 - sh));
 
 	return;
 }
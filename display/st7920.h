@@ -54,6 +54,8 @@ void st7920Init(void);
 void st7920Clear();
 
 void st7920DrawPixel(uint8_t x, uint8_t y, uint8_t color);
+void st7920DrawVertBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask);
+void st7920DrawHorizBits(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask);
 
 uint8_t st7920GetPins(void);
 
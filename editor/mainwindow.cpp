@@ -2,6 +2,7 @@
 
 #include <QDebug>
 #include <QtWidgets>
+#include <QSerialPortInfo>
 
 #include "aboutdialog.h"
 
@@ -10,6 +11,40 @@
 #include "../tuner/tuner.h"
 #include "../tuner/tea5767.h"
 #include "../display.h"
+#include "../uart.h"
+
+// Frame exchange with device, see uart.h of firmware
+#define DEVICE_TIMEOUT      300     // ms, EEPROM part write takes up to 55 ms
+#define DEVICE_RETRIES      3
+#define DEVICE_STANDBY      (MODE_SND_END + 1)  // MODE_STANDBY of actions.h
+
+// Dallas CRC8 as _crc_ibutton_update() of avr-libc
+static quint8 crc8(const QByteArray &data)
+{
+    quint8 crc = 0;
+
+    foreach (char ch, data) {
+        crc ^= (quint8)ch;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x01) ? ((crc >> 1) ^ 0x8C) : (crc >> 1);
+    }
+
+    return crc;
+}
+
+// CRC16 as _crc16_update() of avr-libc
+static quint16 crc16(const QByteArray &data)
+{
+    quint16 crc = 0;
+
+    foreach (char ch, data) {
+        crc ^= (quint8)ch;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x01) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+    }
+
+    return crc;
+}
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent)
@@ -37,6 +72,9 @@ MainWindow::MainWindow(QWidget *parent) :
         wgtTranslations->setItem(y, 0, new QTableWidgetItem());
     wgtTranslations->blockSignals(false);
 
+    devPort = new QSerialPort(this);
+    devSeq = 0;
+
     /* Load default eeprom file */
     readEepromFile(EEPROM_RESOURCE);
 }
@@ -80,6 +118,12 @@ void MainWindow::readEepromFile(QString name)
 
     eep = file.readAll();
     file.close();
+
+    loadEeprom();
+}
+
+void MainWindow::loadEeprom()
+{
     updateHexTable();
 
     // Processing translations
@@ -192,6 +236,230 @@ void MainWindow::loadDefaultEeprom()
     readEepromFile(EEPROM_RESOURCE);
 }
 
+bool MainWindow::deviceOpen()
+{
+    QStringList ports;
+    bool ok;
+
+    foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts())
+        ports << info.portName();
+    if (ports.isEmpty()) {
+        Ui_MainWindow::statusBar->showMessage(tr("No serial ports found"));
+        return false;
+    }
+
+    QString name = QInputDialog::getItem(this, tr("Device"), tr("Serial port"),
+                                         ports, qMax(ports.indexOf(devPort->portName()), 0),
+                                         false, &ok);
+    if (!ok)
+        return false;
+
+    devPort->setPortName(name);
+    devPort->setBaudRate(USART_BAUDRATE);
+    if (!devPort->open(QIODevice::ReadWrite)) {
+        Ui_MainWindow::statusBar->showMessage(tr("Can't open") + " " + name);
+        return false;
+    }
+    devPort->clear();
+
+    return true;
+}
+
+// Reply is status and data. Frame is repeated with the same SEQ on timeout,
+// so device doesn't execute it twice
+bool MainWindow::deviceRequest(quint8 cmd, const QByteArray &data, QByteArray *reply)
+{
+    QByteArray frame;
+    QByteArray rx;
+    quint8 seq = ++devSeq;
+
+    frame.append((char)data.size());
+    frame.append((char)seq);
+    frame.append((char)cmd);
+    frame.append(data);
+    frame.append((char)crc8(frame));
+    frame.prepend((char)UART_SYNC);
+
+    for (int retry = 0; retry < DEVICE_RETRIES; retry++) {
+        QElapsedTimer timer;
+
+        devPort->write(frame);
+        timer.start();
+
+        while (timer.elapsed() < DEVICE_TIMEOUT) {
+            if (!devPort->waitForReadyRead(DEVICE_TIMEOUT))
+                break;
+            rx.append(devPort->readAll());
+
+            // SYNC LEN SEQ CMD DATA[LEN] CRC
+            int pos;
+            while ((pos = rx.indexOf((char)UART_SYNC)) >= 0) {
+                rx.remove(0, pos);
+                if (rx.size() < 2)
+                    break;
+                int len = (quint8)rx.at(1);
+                if (rx.size() < len + 5)
+                    break;
+                QByteArray body = rx.mid(1, len + 3);
+                if ((quint8)rx.at(len + 4) != crc8(body)) {
+                    rx.remove(0, 1);
+                    continue;
+                }
+                rx.remove(0, len + 5);
+
+                if ((quint8)body.at(1) == seq && (quint8)body.at(2) == (cmd | UART_REPLY) && len) {
+                    *reply = body.mid(3);
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+// Returns -1 if device doesn't answer
+int MainWindow::deviceBlockCrc(int block)
+{
+    QByteArray reply;
+
+    if (!deviceRequest(UART_CMD_EEP_CRC, QByteArray(1, (char)block), &reply) ||
+        reply.size() != 3 || reply.at(0) != UART_OK)
+        return -1;
+
+    return (quint8)reply.at(1) | ((quint8)reply.at(2) << 8);
+}
+
+// Only blocks with other CRC are written, so stopped sync continues where it was
+void MainWindow::syncDevice()
+{
+    QByteArray image = eep.leftJustified(EEPROM_SIZE, (char)0xFF, true);
+    int blocks = EEPROM_SIZE / UART_EEP_BLOCK;
+    int written = 0;
+    QByteArray reply;
+    QString error;
+
+    if (!deviceOpen())
+        return;
+
+    QProgressDialog progress(tr("Syncing with device"), tr("Stop"), 0, blocks, this);
+    progress.setWindowModality(Qt::WindowModal);
+
+    // EEPROM is written by device only in standby
+    if (!deviceRequest(UART_CMD_STATUS, QByteArray(), &reply) || reply.size() < 2) {
+        error = tr("Device doesn't answer");
+    } else if ((quint8)reply.at(1) != DEVICE_STANDBY) {
+        if (!deviceRequest(UART_CMD_SET_MODE, QByteArray(1, DEVICE_STANDBY), &reply))
+            error = tr("Device doesn't answer");
+    }
+
+    for (int block = 0; block < blocks && error.isEmpty(); block++) {
+        QByteArray data = image.mid(block * UART_EEP_BLOCK, UART_EEP_BLOCK);
+        int retry;
+
+        progress.setValue(block);
+        if (progress.wasCanceled()) {
+            error = tr("Stopped, sync again to continue");
+            break;
+        }
+
+        for (retry = 0; retry <= DEVICE_RETRIES; retry++) {
+            int crc = deviceBlockCrc(block);
+            if (crc < 0) {
+                error = tr("Device doesn't answer");
+                break;
+            }
+            if (crc == crc16(data))
+                break;
+            if (retry == DEVICE_RETRIES) {
+                error = tr("Block %1 CRC error").arg(block);
+                break;
+            }
+
+            for (int part = 0; part < UART_EEP_BLOCK / UART_EEP_PART && error.isEmpty(); part++) {
+                QByteArray frame;
+                frame.append((char)block);
+                frame.append((char)part);
+                frame.append(data.mid(part * UART_EEP_PART, UART_EEP_PART));
+                if (!deviceRequest(UART_CMD_EEP_WRITE, frame, &reply) || reply.at(0) != UART_OK)
+                    error = tr("Block %1 write error").arg(block);
+            }
+            if (!error.isEmpty())
+                break;
+            if (!retry)
+                written++;
+        }
+    }
+    progress.setValue(blocks);
+
+    // Settings are loaded by firmware on start
+    if (written && error.isEmpty())
+        deviceRequest(UART_CMD_RESET, QByteArray(), &reply);
+
+    devPort->close();
+
+    if (error.isEmpty())
+        Ui_MainWindow::statusBar->showMessage(
+                    tr("Device synced, %1 of %2 blocks written").arg(written).arg(blocks));
+    else
+        Ui_MainWindow::statusBar->showMessage(
+                    error + ", " + tr("%1 blocks written").arg(written));
+}
+
+void MainWindow::readDevice()
+{
+    int blocks = EEPROM_SIZE / UART_EEP_BLOCK;
+    QByteArray image;
+    QByteArray reply;
+    QString error;
+
+    if (!deviceOpen())
+        return;
+
+    QProgressDialog progress(tr("Reading device"), tr("Stop"), 0, blocks, this);
+    progress.setWindowModality(Qt::WindowModal);
+
+    for (int block = 0; block < blocks && error.isEmpty(); block++) {
+        QByteArray data;
+
+        progress.setValue(block);
+        if (progress.wasCanceled()) {
+            error = tr("Stopped");
+            break;
+        }
+
+        for (int part = 0; part < UART_EEP_BLOCK / UART_EEP_PART; part++) {
+            QByteArray frame;
+            frame.append((char)block);
+            frame.append((char)part);
+            if (!deviceRequest(UART_CMD_EEP_READ, frame, &reply) ||
+                reply.size() != UART_EEP_PART + 1 || reply.at(0) != UART_OK) {
+                error = tr("Device doesn't answer");
+                break;
+            }
+            data.append(reply.mid(1));
+        }
+
+        if (error.isEmpty() && deviceBlockCrc(block) != crc16(data))
+            error = tr("Block %1 CRC error").arg(block);
+        image.append(data);
+    }
+    progress.setValue(blocks);
+
+    devPort->close();
+
+    if (!error.isEmpty()) {
+        Ui_MainWindow::statusBar->showMessage(error);
+        return;
+    }
+
+    eep = image;
+    actionSaveEeprom->setEnabled(false);
+    fileName.clear();
+    loadEeprom();
+    Ui_MainWindow::statusBar->showMessage(tr("Read from device"));
+}
+
 void MainWindow::updateTranslation(int row, int column)
 {
     Q_UNUSED(row); Q_UNUSED(column);
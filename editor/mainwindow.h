@@ -5,6 +5,8 @@
 
 #include "lcdconverter.h"
 
+#include <QSerialPort>
+
 #define EEPROM_RESOURCE ":/res/eeprom_en.bin"
 
 class MainWindow : public QMainWindow, private Ui::MainWindow
@@ -22,8 +24,16 @@ private:
     QString fileName;
     QByteArray eep;
 
+    QSerialPort *devPort;
+    quint8 devSeq;
+
     void readEepromFile(QString name);
     void saveEepromFile(QString name);
+    void loadEeprom();
+
+    bool deviceOpen();
+    bool deviceRequest(quint8 cmd, const QByteArray &data, QByteArray *reply);
+    int deviceBlockCrc(int block);
 
     void setAudioParam(QDoubleSpinBox *spb, double min, double max, double step, int param);
 
@@ -42,6 +52,9 @@ private slots:
     void saveEepromAs();
     void loadDefaultEeprom();
 
+    void syncDevice();
+    void readDevice();
+
     void updateTranslation(int row, int column);
 
     void setAudioproc(int proc);
@@ -0,0 +1,147 @@
+#include "eeprom.h"
+
+#include <avr/eeprom.h>
+
+typedef struct {
+	uint8_t *ram;
+	uint8_t *addr;
+	uint8_t size;
+} EepromBlock_type;
+
+static EepromBlock_type blocks[EEPROM_BLOCK_END];
+static uint8_t dirty;							// Bit per block
+static uint8_t cursor;							// Next byte of first dirty block
+
+// Block is written back when its RAM copy is marked dirty
+void eepromBind(uint8_t block, void *ram, void *addr, uint8_t size)
+{
+	blocks[block].ram = ram;
+	blocks[block].addr = addr;
+	blocks[block].size = size;
+
+	return;
+}
+
+void eepromDirty(uint8_t block)
+{
+	uint8_t mask = 1 << block;
+
+	// Changed block being written is checked from the start again
+	if (!(dirty & (mask - 1)))
+		cursor = 0;
+	dirty |= mask;
+
+	return;
+}
+
+// Returns next byte of dirty blocks differing from EEPROM, 0 if all are written
+static uint8_t *eepromNextByte(uint8_t **addr)
+{
+	uint8_t block;
+	EepromBlock_type *b;
+
+	for (block = 0; dirty; block++) {
+		if (!(dirty & (1 << block)))
+			continue;
+		b = &blocks[block];
+		for (; cursor < b->size; cursor++) {
+			*addr = b->addr + cursor;
+			if (eeprom_read_byte(*addr) != b->ram[cursor])
+				return &b->ram[cursor];
+		}
+		dirty &= ~(1 << block);
+		cursor = 0;
+	}
+
+	return 0;
+}
+
+// Write one changed byte if EEPROM is idle, so main loop never waits for it
+void eepromCommitStep(void)
+{
+	uint8_t *data;
+	uint8_t *addr;
+
+	if (!dirty || !eeprom_is_ready())
+		return;
+
+	data = eepromNextByte(&addr);
+	if (data)
+		eeprom_write_byte(addr, *data);
+
+	return;
+}
+
+// Write all changed bytes, before power is off
+void eepromCommit(void)
+{
+	uint8_t *data;
+	uint8_t *addr;
+
+	while ((data = eepromNextByte(&addr)))
+		eeprom_write_byte(addr, *data);
+
+	return;
+}
+
+static uint8_t eepromLogSeq(uint8_t *log, uint8_t num)
+{
+	return eeprom_read_byte(log + num * EEPROM_LOG_REC_SIZE + 2);
+}
+
+// Newest record is the last one with sequence number following previous
+static uint8_t eepromLogHead(uint8_t *log)
+{
+	uint8_t i;
+	uint8_t seq = eepromLogSeq(log, 0);
+
+	if (seq == 0xFF)
+		return EEPROM_LOG_COUNT;				// Empty log
+
+	for (i = 1; i < EEPROM_LOG_COUNT; i++) {
+		if (++seq == 0xFF)
+			seq = 0;
+		if (eepromLogSeq(log, i) != seq)
+			break;
+	}
+
+	return i - 1;
+}
+
+uint8_t eepromLogRead(uint8_t *log, uint16_t *value)
+{
+	uint8_t head = eepromLogHead(log);
+
+	if (head == EEPROM_LOG_COUNT)
+		return 0;
+
+	*value = eeprom_read_word((uint16_t*)(log + head * EEPROM_LOG_REC_SIZE));
+
+	return 1;
+}
+
+// New value goes to next record, so each cell is written once per log turn
+void eepromLogWrite(uint8_t *log, uint16_t value)
+{
+	uint8_t head = eepromLogHead(log);
+	uint8_t seq = 0;
+	uint8_t *rec = log;
+
+	if (head != EEPROM_LOG_COUNT) {
+		rec += head * EEPROM_LOG_REC_SIZE;
+		if (eeprom_read_word((uint16_t*)rec) == value)
+			return;
+		seq = eeprom_read_byte(rec + 2) + 1;
+		if (seq == 0xFF)
+			seq = 0;
+		rec += EEPROM_LOG_REC_SIZE;
+		if (++head == EEPROM_LOG_COUNT)
+			rec = log;
+	}
+
+	// Sequence number is written last, so broken record is not taken as newest
+	eeprom_update_word((uint16_t*)rec, value);
+	eeprom_update_byte(rec + 2, seq);
+
+	return;
+}
@@ -56,9 +56,20 @@
 /* RC commands array */
 #define EEPROM_RC_CMD				0x40
 
+/* Extra remote control type, address and commands array */
+#define EEPROM_RC2_TYPE				0x2C0
+#define EEPROM_RC2_ADDR				0x2C1
+#define EEPROM_RC2_CMD				0x2C2
+
 /* Text labels (maximum 15 byte followed by \0) */
 #define EEPROM_LABELS_ADDR			0x110
 
+/* Rotating logs of often changed values, records of value and sequence number */
+#define EEPROM_LOG_VOLUME			0x300
+#define EEPROM_LOG_FM_FREQ			0x380
+#define EEPROM_LOG_REC_SIZE			3
+#define EEPROM_LOG_COUNT			40
+
 #define EEPROM_SIZE					0x400
 
 /* EEPROM saved labels */
@@ -91,4 +102,21 @@ enum {
 	LABEL_END
 };
 
+/* RAM copies of EEPROM areas written back in background */
+enum {
+	EEPROM_BLOCK_STATIONS,
+	EEPROM_BLOCK_FAV_STATIONS,
+	EEPROM_BLOCK_ALARM,
+
+	EEPROM_BLOCK_END
+};
+
+void eepromBind(uint8_t block, void *ram, void *addr, uint8_t size);
+void eepromDirty(uint8_t block);
+void eepromCommitStep(void);
+void eepromCommit(void);
+
+uint8_t eepromLogRead(uint8_t *log, uint16_t *value);
+void eepromLogWrite(uint8_t *log, uint16_t value);
+
 #endif /* EEPROM_H */
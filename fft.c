@@ -1,13 +1,9 @@
 #include "fft.h"
 #include <avr/pgmspace.h>
 
-static const uint8_t sinTable[] PROGMEM = {
-	0,  25,  50,  74,  98, 120, 142, 162,
-	180, 197, 212, 225, 236, 244, 250, 254,
-	255, 254, 250, 244, 236, 225, 212, 197,
-	180, 162, 142, 120,  98,  74,  50,  25
-};
+static const uint8_t sinTable[N_WAVE / 2] PROGMEM = FFT_SIN_TABLE;
 
+#ifdef __AVR__
 #define mshf_16( a, b)    \
 	({                        \
 	int prod, val1=a, val2=b; \
@@ -28,6 +24,9 @@ static const uint8_t sinTable[] PROGMEM = {
 	);                        \
 	prod;                     \
 	})
+#else
+#define mshf_16(a, b)	((int16_t)(((int32_t)(a) * (b)) >> 8))
+#endif
 
 static inline int16_t sinTbl(uint8_t phi) __attribute__((always_inline));
 static inline int16_t sinTbl(uint8_t phi)
@@ -35,7 +34,7 @@ static inline int16_t sinTbl(uint8_t phi)
 	int16_t ret;
 	uint8_t neg = (phi >= N_WAVE / 2);
 
-	ret = pgm_read_byte(&sinTable[phi & 0x1F]);
+	ret = pgm_read_byte(&sinTable[phi & (N_WAVE / 2 - 1)]);
 
 	return neg ? -ret : ret;
 }
@@ -134,5 +133,58 @@ void fftRad4(int16_t *fr, int16_t *fi)
 			phi += phi0;
 		}
 	}
+
+#if FFT_LOG2 & 1
+	// Odd log2: final radix-2 stage joins two halves
+	m4 = FFT_SIZE / 2;
+	for (i = 0; i < m4; i++) {
+		sin1 = sinTbl(i);
+		cos1 = sinTbl(i + N_WAVE / 4);
+
+		i1 = i + m4;
+		multShf(cos1, sin1, fr[i1], fi[i1], &xr, &xi);
+
+		sumDif(fr[i], xr, &fr[i], &fr[i1]);
+		sumDif(fi[i], xi, &fi[i], &fi[i1]);
+	}
+#endif
+
+	return;
+}
+
+void fftSplit(int16_t *fr, int16_t *fi)
+{
+	uint8_t k, nk;
+	int16_t lr, li, rr, ri;
+
+	// Input was x + j*y, so X[k] = L[k] + j*R[k] with
+	// L[k] = (X[k] + X*[N-k]) / 2 and R[k] = (X[k] - X*[N-k]) / 2j
+	for (k = 1; k < FFT_SIZE / 2; k++) {
+		nk = FFT_SIZE - k;
+
+		sumDif(fr[k] >> 1, fr[nk] >> 1, &lr, &ri);
+		sumDif(fi[k] >> 1, fi[nk] >> 1, &rr, &li);
+
+		fr[k] = lr;
+		fi[k] = li;
+		fr[nk] = rr;
+		fi[nk] = -ri;
+	}
+
+	// DC of both channels, Nyquist bin is dropped
+	fr[FFT_SIZE / 2] = fi[0];
+	fi[FFT_SIZE / 2] = 0;
+	fi[0] = 0;
+
+	// R[k] is at N-k now, reverse it to N/2+k
+	for (k = FFT_SIZE / 2 + 1, nk = FFT_SIZE - 1; k < nk; k++, nk--) {
+		lr = fr[k];
+		fr[k] = fr[nk];
+		fr[nk] = lr;
+		li = fi[k];
+		fi[k] = fi[nk];
+		fi[nk] = li;
+	}
+
 	return;
 }
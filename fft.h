@@ -3,13 +3,13 @@
 
 #include <inttypes.h>
 
-#define FFT_SIZE	64
-#define FFT_LOG2	6
+#include "fft_tables.h"				// FFT_SIZE, FFT_LOG2 and tables, see fft_tables.sh
 
-#define N_WAVE		64
+#define N_WAVE		FFT_SIZE
 
-#define N_DB		32
+#define N_DB		32				// Power of 2, dB levels are found by binary search
 
 void fftRad4(int16_t *fr, int16_t *fi);
+void fftSplit(int16_t *fr, int16_t *fi);
 
 #endif /* FFT_H */
@@ -0,0 +1,67 @@
+#!/bin/sh
+
+# Generates FFT size definitions and PROGMEM table initializers
+# Usage: fft_tables.sh <fft_size> <output header>
+
+size=$1
+out=$2
+
+case ${size} in
+	32)  log2=5 ;;
+	64)  log2=6 ;;
+	128) log2=7 ;;
+	*)
+		echo "fft_tables.sh: unsupported FFT size '${size}' (32, 64 or 128)" >&2
+		exit 1
+		;;
+esac
+
+awk -v size=${size} -v log2=${log2} '
+function table(name, len,    i, line) {
+	printf "#define %s \\\n{ \\\n", name
+	for (i = 0; i < len; i++) {
+		line = line sprintf("%4d,", val[i])
+		if (i % 8 == 7 || i == len - 1) {
+			printf "\t%s \\\n", line
+			line = ""
+		}
+	}
+	printf "}\n\n"
+}
+
+BEGIN {
+	pi = atan2(0, -1)
+
+	printf "/* Generated by fft_tables.sh, do not edit */\n\n"
+	printf "#ifndef FFT_TABLES_H\n#define FFT_TABLES_H\n\n"
+	printf "#define FFT_SIZE\t%d\n", size
+	printf "#define FFT_LOG2\t%d\n\n", log2
+
+	# Sine half wave, scaled to 255
+	for (i = 0; i < size / 2; i++)
+		val[i] = int(255 * sin(2 * pi * i / size) + 0.5)
+	table("FFT_SIN_TABLE", size / 2)
+
+	# Hann window first half, scaled to 255
+	for (i = 0; i < size / 2; i++)
+		val[i] = int(255 * 0.5 * (1 - cos(2 * pi * i / (size - 1))) + 0.5)
+	table("FFT_HANN_TABLE", size / 2)
+
+	# Index with reversed bit order
+	for (i = 0; i < size; i++) {
+		val[i] = 0
+		for (b = 0; b < log2; b++)
+			if (int(i / 2 ^ b) % 2)
+				val[i] += 2 ^ (log2 - 1 - b)
+	}
+	table("FFT_REV_TABLE", size)
+
+	printf "#endif /* FFT_TABLES_H */\n"
+}' > ${out}.tmp || exit 1
+
+# Keep timestamp if nothing changed, so sources are rebuilt only on size change
+if cmp -s ${out}.tmp ${out}; then
+	rm -f ${out}.tmp
+else
+	mv ${out}.tmp ${out}
+fi
@@ -0,0 +1,24 @@
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+/* EEPROM is backed by a file on host, see host/hal.c */
+
+#include <inttypes.h>
+#include <stddef.h>
+
+uint8_t eeprom_read_byte(const uint8_t *addr);
+uint16_t eeprom_read_word(const uint16_t *addr);
+void eeprom_read_block(void *dst, const void *src, size_t n);
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value);
+void eeprom_write_word(uint16_t *addr, uint16_t value);
+void eeprom_write_block(const void *src, void *dst, size_t n);
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value);
+void eeprom_update_word(uint16_t *addr, uint16_t value);
+void eeprom_update_block(const void *src, void *dst, size_t n);
+
+#define eeprom_is_ready()		1
+#define eeprom_busy_wait()		do { } while (0)
+
+#endif /* HOST_AVR_EEPROM_H */
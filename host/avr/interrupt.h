@@ -0,0 +1,13 @@
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+/* Interrupt vectors are called from host/hal.c timer thread */
+
+#include "../hal.h"
+
+#define ISR(vector, ...)		void vector(void)
+
+#define sei()					hostSei()
+#define cli()					hostCli()
+
+#endif /* HOST_AVR_INTERRUPT_H */
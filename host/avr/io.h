@@ -0,0 +1,231 @@
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+/* ATmega32 I/O registers for host build, backed by memory in host/hal.c */
+
+#include <inttypes.h>
+
+extern volatile uint8_t hostIoMem[];
+extern volatile uint8_t hostPinLow[];				// Pins pulled low from outside
+
+#define _SFR_IO8(addr)			(*(volatile uint8_t *)(hostIoMem + (addr)))
+#define _SFR_IO16(addr)			(*(volatile uint16_t *)(hostIoMem + (addr)))
+
+#define _BV(bit)				(1 << (bit))
+#define bit_is_set(sfr, bit)	((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit)	(!((sfr) & _BV(bit)))
+#define loop_until_bit_is_set(sfr, bit)		do { } while (bit_is_clear(sfr, bit))
+#define loop_until_bit_is_clear(sfr, bit)	do { } while (bit_is_set(sfr, bit))
+
+/* avr-gcc builtins used by firmware */
+#define __builtin_avr_swap(x)	((uint8_t)(((x) << 4) | ((uint8_t)(x) >> 4)))
+
+#define E2END					0x3FF
+
+/* I/O registers */
+#define TWBR					_SFR_IO8(0x00)
+#define TWSR					_SFR_IO8(0x01)
+#define TWAR					_SFR_IO8(0x02)
+#define TWDR					_SFR_IO8(0x03)
+#define ADCL					_SFR_IO8(0x04)
+#define ADCH					_SFR_IO8(0x05)
+#define ADC						_SFR_IO16(0x04)
+#define ADCSRA					_SFR_IO8(0x06)
+#define ADMUX					_SFR_IO8(0x07)
+#define ACSR					_SFR_IO8(0x08)
+#define UBRRL					_SFR_IO8(0x09)
+#define UCSRB					_SFR_IO8(0x0A)
+#define UCSRA					_SFR_IO8(0x0B)
+#define UDR						_SFR_IO8(0x0C)
+#define SPCR					_SFR_IO8(0x0D)
+#define SPSR					_SFR_IO8(0x0E)
+#define SPDR					_SFR_IO8(0x0F)
+#define PIND					((uint8_t)(PORTD & ~hostPinLow[3]))
+#define DDRD					_SFR_IO8(0x11)
+#define PORTD					_SFR_IO8(0x12)
+#define PINC					((uint8_t)(PORTC & ~hostPinLow[2]))
+#define DDRC					_SFR_IO8(0x14)
+#define PORTC					_SFR_IO8(0x15)
+#define PINB					((uint8_t)(PORTB & ~hostPinLow[1]))
+#define DDRB					_SFR_IO8(0x17)
+#define PORTB					_SFR_IO8(0x18)
+#define PINA					((uint8_t)(PORTA & ~hostPinLow[0]))
+#define DDRA					_SFR_IO8(0x1A)
+#define PORTA					_SFR_IO8(0x1B)
+#define EECR					_SFR_IO8(0x1C)
+#define EEDR					_SFR_IO8(0x1D)
+#define EEAR					_SFR_IO16(0x1E)
+#define UBRRH					_SFR_IO8(0x20)
+#define UCSRC					_SFR_IO8(0x20)
+#define WDTCR					_SFR_IO8(0x21)
+#define ASSR					_SFR_IO8(0x22)
+#define OCR2					_SFR_IO8(0x23)
+#define TCNT2					_SFR_IO8(0x24)
+#define TCCR2					_SFR_IO8(0x25)
+#define ICR1					_SFR_IO16(0x26)
+#define OCR1B					_SFR_IO16(0x28)
+#define OCR1A					_SFR_IO16(0x2A)
+#define TCNT1					_SFR_IO16(0x2C)
+#define TCCR1B					_SFR_IO8(0x2E)
+#define TCCR1A					_SFR_IO8(0x2F)
+#define SFIOR					_SFR_IO8(0x30)
+#define TCNT0					_SFR_IO8(0x32)
+#define TCCR0					_SFR_IO8(0x33)
+#define MCUCSR					_SFR_IO8(0x34)
+#define MCUCR					_SFR_IO8(0x35)
+#define TWCR					_SFR_IO8(0x36)
+#define TIFR					_SFR_IO8(0x38)
+#define TIMSK					_SFR_IO8(0x39)
+#define GIFR					_SFR_IO8(0x3A)
+#define GICR					_SFR_IO8(0x3B)
+#define OCR0					_SFR_IO8(0x3C)
+#define SREG					_SFR_IO8(0x3F)
+
+#define HOST_IO_SIZE			0x40
+
+/* TWCR */
+#define TWINT					7
+#define TWEA					6
+#define TWSTA					5
+#define TWSTO					4
+#define TWWC					3
+#define TWEN					2
+#define TWIE					0
+
+/* TWSR */
+#define TWPS1					1
+#define TWPS0					0
+
+/* ADCSRA */
+#define ADEN					7
+#define ADSC					6
+#define ADATE					5
+#define ADIF					4
+#define ADIE					3
+#define ADPS2					2
+#define ADPS1					1
+#define ADPS0					0
+
+/* ADMUX */
+#define REFS1					7
+#define REFS0					6
+#define ADLAR					5
+#define MUX4					4
+#define MUX3					3
+#define MUX2					2
+#define MUX1					1
+#define MUX0					0
+
+/* UCSRA */
+#define RXC						7
+#define TXC						6
+#define UDRE					5
+#define FE						4
+#define DOR						3
+#define PE						2
+#define U2X						1
+#define MPCM					0
+
+/* UCSRB */
+#define RXCIE					7
+#define TXCIE					6
+#define UDRIE					5
+#define RXEN					4
+#define TXEN					3
+#define UCSZ2					2
+#define RXB8					1
+#define TXB8					0
+
+/* UCSRC */
+#define URSEL					7
+#define UMSEL					6
+#define UPM1					5
+#define UPM0					4
+#define USBS					3
+#define UCSZ1					2
+#define UCSZ0					1
+#define UCPOL					0
+
+/* SPCR */
+#define SPIE					7
+#define SPE						6
+#define DORD					5
+#define MSTR					4
+#define CPOL					3
+#define CPHA					2
+#define SPR1					1
+#define SPR0					0
+
+/* SPSR */
+#define SPIF					7
+#define WCOL					6
+#define SPI2X					0
+
+/* TCCR0 */
+#define FOC0					7
+#define WGM00					6
+#define COM01					5
+#define COM00					4
+#define WGM01					3
+#define CS02					2
+#define CS01					1
+#define CS00					0
+
+/* TCCR1B */
+#define ICNC1					7
+#define ICES1					6
+#define WGM13					4
+#define WGM12					3
+#define CS12					2
+#define CS11					1
+#define CS10					0
+
+/* TCCR2 */
+#define FOC2					7
+#define WGM20					6
+#define COM21					5
+#define COM20					4
+#define WGM21					3
+#define CS22					2
+#define CS21					1
+#define CS20					0
+
+/* TIMSK */
+#define OCIE2					7
+#define TOIE2					6
+#define TICIE1					5
+#define OCIE1A					4
+#define OCIE1B					3
+#define TOIE1					2
+#define OCIE0					1
+#define TOIE0					0
+
+/* TIFR */
+#define OCF2					7
+#define TOV2					6
+#define ICF1					5
+#define OCF1A					4
+#define OCF1B					3
+#define TOV1					2
+#define OCF0					1
+#define TOV0					0
+
+/* GICR */
+#define INT1					7
+#define INT0					6
+#define INT2					5
+
+/* MCUCR */
+#define SE						7
+#define SM2						6
+#define SM1						5
+#define SM0						4
+#define ISC11					3
+#define ISC10					2
+#define ISC01					1
+#define ISC00					0
+
+/* SREG */
+#define SREG_I					7
+
+#endif /* HOST_AVR_IO_H */
@@ -0,0 +1,22 @@
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+/* Program memory is ordinary memory on host */
+
+#include <inttypes.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)					(s)
+
+typedef const char *PGM_P;
+
+#define pgm_read_byte(addr)		(*(const uint8_t *)(addr))
+#define pgm_read_word(addr)		(*(addr))
+#define pgm_read_dword(addr)	(*(addr))
+
+#define strcpy_P(dst, src)		strcpy((dst), (src))
+#define strlen_P(src)			strlen(src)
+#define memcpy_P(dst, src, n)	memcpy((dst), (src), (n))
+
+#endif /* HOST_AVR_PGMSPACE_H */
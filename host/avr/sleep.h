@@ -0,0 +1,15 @@
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+/* Idle sleep waits for next host timer tick */
+
+#include "../hal.h"
+
+#define SLEEP_MODE_IDLE			0
+
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()				hostSleep()
+
+#endif /* HOST_AVR_SLEEP_H */
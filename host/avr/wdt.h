@@ -0,0 +1,14 @@
+#ifndef HOST_AVR_WDT_H
+#define HOST_AVR_WDT_H
+
+/* Watchdog reset starts firmware process again, see host/hal.c */
+
+#include "../hal.h"
+
+#define WDTO_15MS				0
+
+#define wdt_enable(value)		hostReset()
+#define wdt_reset()				do { } while (0)
+#define wdt_disable()			do { } while (0)
+
+#endif /* HOST_AVR_WDT_H */
@@ -0,0 +1,534 @@
+#include "hal.h"
+
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <util/twi.h>
+
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef HOST_EEPROM
+#define HOST_EEPROM				"eeprom.bin"
+#endif
+
+#define EEPROM_SIZE_HOST		(E2END + 1)
+
+volatile uint8_t hostIoMem[HOST_IO_SIZE] __attribute__((aligned(2)));
+volatile uint8_t hostPinLow[HOST_PORT_END];
+
+// Interrupt vectors, defined by firmware modules present in the build
+void TIMER0_OVF_vect(void) __attribute__((weak));
+void TIMER1_OVF_vect(void) __attribute__((weak));
+void TIMER2_COMP_vect(void) __attribute__((weak));
+void ADC_vect(void) __attribute__((weak));
+void TWI_vect(void) __attribute__((weak));
+void USART_RXC_vect(void) __attribute__((weak));
+void USART_UDRE_vect(void) __attribute__((weak));
+
+static pthread_t halThread;
+static pthread_mutex_t halLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tickCond = PTHREAD_COND_INITIALIZER;
+static uint8_t mainLocked;
+
+static uint8_t eepMem[EEPROM_SIZE_HOST];
+static int eepFd = -1;
+
+static volatile uint64_t cycles;
+static uint64_t runCycles;
+
+static struct {
+	uint32_t tim0;
+	uint32_t tim1;
+	uint32_t tim2;
+	uint32_t adc;
+	uint32_t uart;
+} acc;
+
+static uint8_t adcPending;
+static uint8_t twiActive;
+
+// Scripted pin changes, see pinScriptLoad()
+static struct {
+	uint64_t cycle;
+	uint8_t port;
+	uint8_t mask;
+	uint8_t level;
+} pinScript[HOST_PIN_EVENTS];
+static uint16_t pinScriptLen;
+static uint16_t pinScriptPos;
+
+static const uint16_t tim01Presc[] = {0, 1, 8, 64, 256, 1024, 0, 0};
+static const uint16_t tim2Presc[] = {0, 1, 8, 32, 64, 128, 256, 1024};
+
+static uint8_t onHalThread(void)
+{
+	return halThread && pthread_equal(pthread_self(), halThread);
+}
+
+void hostSei(void)
+{
+	SREG |= (1<<SREG_I);
+
+	if (!onHalThread() && mainLocked) {
+		mainLocked = 0;
+		pthread_mutex_unlock(&halLock);
+	}
+
+	return;
+}
+
+void hostCli(void)
+{
+	if (!onHalThread() && !mainLocked) {
+		pthread_mutex_lock(&halLock);
+		mainLocked = 1;
+	}
+
+	SREG &= ~(1<<SREG_I);
+
+	return;
+}
+
+void hostSleep(void)
+{
+	// Like idle sleep, wakes up after interrupts of next tick
+	if (onHalThread() || mainLocked)
+		return;
+
+	pthread_mutex_lock(&halLock);
+	pthread_cond_wait(&tickCond, &halLock);
+	pthread_mutex_unlock(&halLock);
+
+	return;
+}
+
+void hostDelayUs(double us)
+{
+	struct timespec ts, now;
+
+	// Short delays are busy waits like on the target
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ts.tv_nsec += (long)(us * 1000);
+	ts.tv_sec += ts.tv_nsec / 1000000000;
+	ts.tv_nsec %= 1000000000;
+
+	if (us >= 1000) {
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+	} else {
+		do {
+			clock_gettime(CLOCK_MONOTONIC, &now);
+		} while (now.tv_sec < ts.tv_sec ||
+				 (now.tv_sec == ts.tv_sec && now.tv_nsec < ts.tv_nsec));
+	}
+
+	return;
+}
+
+void hostPinSet(uint8_t port, uint8_t mask, uint8_t level)
+{
+	if (port >= HOST_PORT_END)
+		return;
+
+	if (level)
+		hostPinLow[port] &= ~mask;
+	else
+		hostPinLow[port] |= mask;
+
+	return;
+}
+
+// Watchdog reset: firmware starts again with the same EEPROM file and stdio
+void hostReset(void)
+{
+	fprintf(stderr, "hal: watchdog reset\n");
+	execl("/proc/self/exe", "/proc/self/exe", (char *)NULL);
+	perror("hal: reset");
+	exit(1);
+}
+
+static void eepromSync(uint16_t addr, uint16_t len)
+{
+	if (eepFd < 0)
+		return;
+
+	if (pwrite(eepFd, &eepMem[addr], len, addr) != len)
+		perror("eeprom");
+
+	return;
+}
+
+static uint16_t eepromAddr(const void *addr, size_t n)
+{
+	uintptr_t a = (uintptr_t)addr;
+
+	if (a + n > EEPROM_SIZE_HOST) {
+		fprintf(stderr, "eeprom: access out of range 0x%04lx\n", (unsigned long)a);
+		abort();
+	}
+
+	return a;
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+	return eepMem[eepromAddr(addr, 1)];
+}
+
+uint16_t eeprom_read_word(const uint16_t *addr)
+{
+	uint16_t a = eepromAddr(addr, 2);
+
+	return eepMem[a] | (eepMem[a + 1] << 8);
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+	memcpy(dst, &eepMem[eepromAddr(src, n)], n);
+
+	return;
+}
+
+void eeprom_write_block(const void *src, void *dst, size_t n)
+{
+	uint16_t a = eepromAddr(dst, n);
+
+	memcpy(&eepMem[a], src, n);
+	eepromSync(a, n);
+
+	return;
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value)
+{
+	eeprom_write_block(&value, addr, 1);
+
+	return;
+}
+
+void eeprom_write_word(uint16_t *addr, uint16_t value)
+{
+	uint8_t data[2] = {value & 0xFF, value >> 8};
+
+	eeprom_write_block(data, addr, 2);
+
+	return;
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+	uint16_t a = eepromAddr(dst, n);
+
+	if (memcmp(&eepMem[a], src, n))
+		eeprom_write_block(src, dst, n);
+
+	return;
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value)
+{
+	eeprom_update_block(&value, addr, 1);
+
+	return;
+}
+
+void eeprom_update_word(uint16_t *addr, uint16_t value)
+{
+	uint8_t data[2] = {value & 0xFF, value >> 8};
+
+	eeprom_update_block(data, addr, 2);
+
+	return;
+}
+
+static void eepromLoad(void)
+{
+	const char *path = getenv("AMPCONTROL_EEPROM");
+	ssize_t len;
+
+	if (!path)
+		path = HOST_EEPROM;
+
+	memset(eepMem, 0xFF, sizeof(eepMem));
+
+	eepFd = open(path, O_RDWR | O_CREAT, 0644);
+	if (eepFd < 0) {
+		perror(path);
+		return;
+	}
+
+	len = read(eepFd, eepMem, sizeof(eepMem));
+	if (len < (ssize_t)sizeof(eepMem))
+		eepromSync(len > 0 ? len : 0, sizeof(eepMem) - (len > 0 ? len : 0));
+
+	return;
+}
+
+// Lines "<seconds> <port A..D> <mask> <level>", e.g. "1.5 D 0x04 0"
+static void pinScriptLoad(void)
+{
+	const char *path = getenv("AMPCONTROL_PINS");
+	FILE *f;
+	char line[64], port;
+	double t;
+	unsigned mask, level;
+
+	if (!path)
+		return;
+
+	f = fopen(path, "r");
+	if (!f) {
+		perror(path);
+		return;
+	}
+
+	while (pinScriptLen < HOST_PIN_EVENTS && fgets(line, sizeof(line), f)) {
+		if (sscanf(line, "%lf %c %i %u", &t, &port, &mask, &level) != 4)
+			continue;
+		pinScript[pinScriptLen].cycle = (uint64_t)(t * F_CPU);
+		pinScript[pinScriptLen].port = port - 'A';
+		pinScript[pinScriptLen].mask = mask;
+		pinScript[pinScriptLen].level = level;
+		pinScriptLen++;
+	}
+
+	fclose(f);
+
+	return;
+}
+
+static void pinScriptRun(void)
+{
+	while (pinScriptPos < pinScriptLen && cycles >= pinScript[pinScriptPos].cycle) {
+		hostPinSet(pinScript[pinScriptPos].port, pinScript[pinScriptPos].mask,
+				   pinScript[pinScriptPos].level);
+		pinScriptPos++;
+	}
+
+	return;
+}
+
+static uint8_t adcSignal(uint8_t mux)
+{
+	// Two tones per channel, walking slowly over the spectrum
+	double t = (double)cycles / F_CPU;
+	double f = 200.0 + 3000.0 * (0.5 + 0.5 * sin(2 * M_PI * 0.1 * t));
+	double v;
+
+	if (mux & 0x01)
+		v = 0.6 * sin(2 * M_PI * f * 1.5 * t) + 0.3 * sin(2 * M_PI * 800.0 * t);
+	else
+		v = 0.6 * sin(2 * M_PI * f * t) + 0.3 * sin(2 * M_PI * 5000.0 * t);
+
+	return 128 + (int8_t)(v * HOST_ADC_AMPLITUDE);
+}
+
+static void adcComplete(void)
+{
+	uint16_t val = adcSignal(ADMUX & 0x07) << 2;
+
+	if (ADMUX & (1<<ADLAR)) {
+		ADCL = (val << 6) & 0xFF;
+		ADCH = val >> 2;
+	} else {
+		ADCL = val & 0xFF;
+		ADCH = val >> 8;
+	}
+
+	ADCSRA &= ~(1<<ADSC);
+	ADCSRA |= (1<<ADIF);
+
+	if ((ADCSRA & (1<<ADIE)) && ADC_vect) {
+		ADCSRA &= ~(1<<ADIF);
+		ADC_vect();
+	}
+
+	return;
+}
+
+static void uartReceive(void)
+{
+	struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+	uint8_t ch;
+
+	if (poll(&pfd, 1, 0) <= 0 || !(pfd.revents & POLLIN))
+		return;
+	if (read(STDIN_FILENO, &ch, 1) != 1)
+		return;
+
+	UDR = ch;
+	UCSRA |= (1<<RXC);
+	USART_RXC_vect();
+	UCSRA &= ~(1<<RXC);
+
+	return;
+}
+
+// Vector either writes UDR or disables its interrupt when nothing to send
+static void uartTransmit(void)
+{
+	uint8_t ch;
+
+	USART_UDRE_vect();
+	if (!(UCSRB & (1<<UDRIE)))
+		return;
+
+	// Transmitter is stopped if output is closed
+	ch = UDR;
+	if (write(STDOUT_FILENO, &ch, 1) != 1)
+		UCSRB &= ~(1<<TXEN);
+
+	return;
+}
+
+static void halTick(uint32_t tickCycles)
+{
+	uint32_t period, cnt;
+	uint16_t presc;
+	uint8_t twiStatus;
+
+	cycles += tickCycles;
+
+	// Timer0 overflow, reload value is written by ISR
+	presc = tim01Presc[TCCR0 & 0x07];
+	if (presc && (TIMSK & (1<<TOIE0)) && TIMER0_OVF_vect) {
+		acc.tim0 += tickCycles;
+		period = (uint32_t)presc * (256 - TCNT0);
+		while (acc.tim0 >= period) {
+			acc.tim0 -= period;
+			TCNT0 = 0;
+			TIMER0_OVF_vect();
+			period = (uint32_t)presc * (256 - TCNT0);
+		}
+	}
+
+	// ADC conversion takes 13 ADC clocks
+	if ((ADCSRA & (1<<ADEN)) && (ADCSRA & (1<<ADSC))) {
+		acc.adc += tickCycles;
+		presc = ADCSRA & 0x07;
+		period = 13 * (presc ? (1 << presc) : 2);
+		if (!adcPending) {
+			adcPending = 1;
+			acc.adc = 0;
+		} else if (acc.adc >= period) {
+			adcPending = 0;
+			adcComplete();
+		}
+	}
+
+	// Timer1 free running, overflow
+	presc = tim01Presc[TCCR1B & 0x07];
+	if (presc) {
+		acc.tim1 += tickCycles;
+		cnt = TCNT1 + acc.tim1 / presc;
+		acc.tim1 %= presc;
+		TCNT1 = cnt;
+		if (cnt > 0xFFFF && (TIMSK & (1<<TOIE1)) && TIMER1_OVF_vect)
+			TIMER1_OVF_vect();
+	}
+
+	// Timer2 in CTC mode
+	presc = tim2Presc[TCCR2 & 0x07];
+	if (presc && (TIMSK & (1<<OCIE2)) && TIMER2_COMP_vect) {
+		acc.tim2 += tickCycles;
+		period = (uint32_t)presc * (OCR2 + 1);
+		while (acc.tim2 >= period) {
+			acc.tim2 -= period;
+			TIMER2_COMP_vect();
+		}
+	}
+
+	// TWI: no devices on bus, transfers complete immediately and
+	// interrupt driven ones get every address not acknowledged
+	if ((TWCR & (1<<TWEN)) && (TWCR & (1<<TWIE)) && TWI_vect) {
+		if (TWCR & (1<<TWSTA))
+			twiStatus = (twiActive && !(TWCR & (1<<TWSTO))) ? TW_REP_START : TW_START;
+		else
+			twiStatus = (TWDR & 0x01) ? TW_MR_SLA_NACK : TW_MT_SLA_NACK;
+		twiActive = 1;
+		TWSR = (TWSR & ~TW_STATUS_MASK) | twiStatus;
+		TWCR &= ~((1<<TWSTA) | (1<<TWSTO));
+		TWI_vect();
+	}
+	if (TWCR & (1<<TWSTO))
+		twiActive = 0;
+	TWCR &= ~(1<<TWSTO);
+
+	// UART transmitter is always ready, bytes go to stdout at the baud
+	// rate, 10 bits each in U2X mode
+	UCSRA |= (1<<UDRE);
+	if ((UCSRB & (1<<TXEN)) && (UCSRB & (1<<UDRIE)) && USART_UDRE_vect) {
+		acc.uart += tickCycles;
+		period = 10 * 8 * (UBRRL + 1);
+		while (acc.uart >= period && (UCSRB & (1<<UDRIE))) {
+			acc.uart -= period;
+			uartTransmit();
+		}
+	} else {
+		acc.uart = 0;
+	}
+
+	// UART receiver is fed from stdin
+	if ((UCSRB & (1<<RXEN)) && (UCSRB & (1<<RXCIE)) && USART_RXC_vect)
+		uartReceive();
+
+	return;
+}
+
+static void *halRun(void *arg)
+{
+	struct timespec ts;
+	uint32_t tickCycles = (uint64_t)F_CPU * HOST_TICK_US / 1000000;
+
+	(void)arg;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	while (1) {
+		ts.tv_nsec += HOST_TICK_US * 1000;
+		if (ts.tv_nsec >= 1000000000) {
+			ts.tv_nsec -= 1000000000;
+			ts.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+		pthread_mutex_lock(&halLock);
+		pinScriptRun();
+		if (SREG & (1<<SREG_I))
+			halTick(tickCycles);
+		else
+			cycles += tickCycles;
+		pthread_cond_broadcast(&tickCond);
+		pthread_mutex_unlock(&halLock);
+
+		if (runCycles && cycles >= runCycles)
+			exit(0);
+	}
+
+	return NULL;
+}
+
+static void __attribute__((constructor)) halInit(void)
+{
+	const char *runtime = getenv("AMPCONTROL_RUNTIME");
+
+	if (runtime)
+		runCycles = (uint64_t)(atof(runtime) * F_CPU);
+
+	eepromLoad();
+	pinScriptLoad();
+
+	// Reset values
+	UCSRA = (1<<UDRE);
+	UCSRC = (1<<UCSZ1) | (1<<UCSZ0);
+
+	pthread_create(&halThread, NULL, halRun, NULL);
+
+	return;
+}
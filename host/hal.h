@@ -0,0 +1,35 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <inttypes.h>
+
+// Host timer thread tick, us
+#define HOST_TICK_US			50
+
+// Synthetic audio signal on ADC inputs
+#define HOST_ADC_AMPLITUDE		100
+
+// Max pin changes in AMPCONTROL_PINS script
+#define HOST_PIN_EVENTS			256
+
+// Host port indexes for hostPinSet()
+enum {
+	HOST_PORT_A = 0,
+	HOST_PORT_B,
+	HOST_PORT_C,
+	HOST_PORT_D,
+
+	HOST_PORT_END
+};
+
+void hostSei(void);
+void hostCli(void);
+
+void hostDelayUs(double us);
+void hostSleep(void);
+
+void hostPinSet(uint8_t port, uint8_t mask, uint8_t level);
+
+void hostReset(void);
+
+#endif /* HAL_H */
@@ -0,0 +1,36 @@
+#ifndef HOST_UTIL_CRC16_H
+#define HOST_UTIL_CRC16_H
+
+#include <inttypes.h>
+
+static inline uint8_t _crc_ibutton_update(uint8_t crc, uint8_t data)
+{
+	uint8_t i;
+
+	crc ^= data;
+	for (i = 0; i < 8; i++) {
+		if (crc & 0x01)
+			crc = (crc >> 1) ^ 0x8C;
+		else
+			crc >>= 1;
+	}
+
+	return crc;
+}
+
+static inline uint16_t _crc16_update(uint16_t crc, uint8_t data)
+{
+	uint8_t i;
+
+	crc ^= data;
+	for (i = 0; i < 8; i++) {
+		if (crc & 0x01)
+			crc = (crc >> 1) ^ 0xA001;
+		else
+			crc >>= 1;
+	}
+
+	return crc;
+}
+
+#endif /* HOST_UTIL_CRC16_H */
@@ -0,0 +1,9 @@
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+#include "../hal.h"
+
+#define _delay_us(us)			hostDelayUs(us)
+#define _delay_ms(ms)			hostDelayUs((ms) * 1000.0)
+
+#endif /* HOST_UTIL_DELAY_H */
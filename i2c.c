@@ -1,14 +1,164 @@
 #include "i2c.h"
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <util/twi.h>
+
+#define I2C_QUEUE_MASK		(I2C_QUEUE_LEN - 1)
+#define I2C_RING_MASK		(I2C_RING_LEN - 1)
+
+#define I2C_NEXT			((1<<TWINT) | (1<<TWEN) | (1<<TWIE))
+
+typedef struct {
+	uint8_t addr;
+	uint8_t twbr;						// Bit rate of transaction
+	uint8_t wLen;						// Bytes taken from ring
+	uint8_t xLen;						// Bytes sent from caller buffer after them
+	const uint8_t *xBuf;
+	uint8_t rLen;						// Bytes read after repeated start
+	uint8_t *rBuf;
+	volatile uint8_t *state;
+} I2CTrans;
+
+static I2CTrans queue[I2C_QUEUE_LEN];
+static volatile uint8_t qHead;			// Next free, written by main loop
+static volatile uint8_t qTail;			// Running, written by ISR
+static volatile uint8_t busy;
+
+static uint8_t ring[I2C_RING_LEN];
+static uint8_t ringWr;
+static volatile uint8_t ringRd;
+static uint8_t buildLen;				// Bytes of transaction not yet submitted
+
+static uint8_t wPos;
+static uint8_t rPos;
+
+static void I2CReset(void)
+{
+	// Bus is stuck: drop queued transactions, keep one being built
+	TWCR = 0;
+	while (qTail != qHead) {
+		if (queue[qTail & I2C_QUEUE_MASK].state)
+			*queue[qTail & I2C_QUEUE_MASK].state = I2C_FAILED;
+		qTail++;
+	}
+	ringRd = ringWr - buildLen;
+	busy = 0;
+	TWCR = (1<<TWEN);
+
+	return;
+}
+
+static void I2CWaitQueue(uint8_t trans, uint8_t bytes)
+{
+	uint16_t i = 0;
+
+	while ((uint8_t)(qHead - qTail) > trans || (uint8_t)(ringWr - ringRd) > bytes) {
+		if (i++ > I2C_TIMEOUT) {
+			I2CReset();
+			break;
+		}
+		_delay_us(10);
+	}
+
+	return;
+}
+
+static void I2CSubmit(void)
+{
+	uint8_t sreg = SREG;
+
+	queue[qHead & I2C_QUEUE_MASK].wLen = buildLen;
+	buildLen = 0;
+
+	cli();
+	qHead++;
+	if (!busy) {
+		busy = 1;
+		TWBR = queue[qTail & I2C_QUEUE_MASK].twbr;
+		TWCR = I2C_NEXT | (1<<TWSTA);
+	}
+	if (sreg & (1<<SREG_I))						// May be called before interrupts are on
+		sei();
+
+	return;
+}
+
+ISR (TWI_vect)
+{
+	I2CTrans *t = &queue[qTail & I2C_QUEUE_MASK];
+	uint8_t state = I2C_FAILED;
+
+	switch (TW_STATUS) {
+	case TW_START:
+		wPos = 0;
+		TWDR = (t->wLen || !t->rLen) ? t->addr : t->addr | I2C_READ;
+		TWCR = I2C_NEXT;
+		return;
+	case TW_REP_START:
+		rPos = 0;
+		TWDR = t->addr | I2C_READ;
+		TWCR = I2C_NEXT;
+		return;
+	case TW_MT_SLA_ACK:
+	case TW_MT_DATA_ACK:
+		if (wPos < t->wLen) {
+			TWDR = ring[ringRd++ & I2C_RING_MASK];
+			wPos++;
+			TWCR = I2C_NEXT;
+			return;
+		}
+		if (wPos - t->wLen < t->xLen) {
+			TWDR = t->xBuf[wPos - t->wLen];
+			wPos++;
+			TWCR = I2C_NEXT;
+			return;
+		}
+		if (t->rLen) {
+			TWCR = I2C_NEXT | (1<<TWSTA);
+			return;
+		}
+		state = I2C_DONE;
+		break;
+	case TW_MR_SLA_ACK:
+		rPos = 0;
+		TWCR = I2C_NEXT | (t->rLen > 1 ? (1<<TWEA) : 0);
+		return;
+	case TW_MR_DATA_ACK:
+		t->rBuf[rPos++] = TWDR;
+		TWCR = I2C_NEXT | (rPos + 1 < t->rLen ? (1<<TWEA) : 0);
+		return;
+	case TW_MR_DATA_NACK:
+		t->rBuf[rPos] = TWDR;
+		state = I2C_DONE;
+		break;
+	default:									// NACK, lost arbitration, bus error
+		break;
+	}
+
+	// Transaction is over, skip bytes not sent on error
+	if (wPos < t->wLen)
+		ringRd += t->wLen - wPos;
+	if (t->state)
+		*t->state = state;
+
+	if (++qTail != qHead) {
+		TWBR = queue[qTail & I2C_QUEUE_MASK].twbr;
+		TWCR = I2C_NEXT | (1<<TWSTO) | (1<<TWSTA);	// Stop, then start next one
+	} else {
+		TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTO);
+		busy = 0;
+	}
+}
 
 void I2CInit(void)
 {
 	// SCL = F_CPU / (16 + 2 * TWBR * prescaler)
-	// SCL = 16000000 / (16 + 2 * 18 * 4)
+	// SCL = 16000000 / (16 + 2 * 72 * 1)
 
-	TWBR = 18;
-	TWSR = (0<<TWPS1) | (1<<TWPS0);					// Prescaler = 4
+	TWBR = I2C_TWBR_STD;
+	TWSR = (0<<TWPS1) | (0<<TWPS0);					// Prescaler = 1
 
 	TWCR |= (1<<TWEN);								// Enable TWI
 
@@ -19,6 +169,9 @@ void I2CStart(uint8_t addr)
 {
 	uint8_t i = 0;
 
+	I2CWait();										// Let queued transactions finish
+
+	TWBR = I2C_TWBR_STD;
 	TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTA);		// Start
 
 	while(bit_is_clear(TWCR, TWINT)) {
@@ -78,3 +231,83 @@ uint8_t I2CReadByte(uint8_t ack)
 
 	return TWDR;
 }
+
+void I2CQueueStart(uint8_t addr)
+{
+	I2CWaitQueue(I2C_QUEUE_LEN - 1, I2C_RING_LEN);
+
+	queue[qHead & I2C_QUEUE_MASK].addr = addr;
+	queue[qHead & I2C_QUEUE_MASK].twbr = I2C_TWBR_STD;
+	queue[qHead & I2C_QUEUE_MASK].xLen = 0;
+	queue[qHead & I2C_QUEUE_MASK].rLen = 0;
+	queue[qHead & I2C_QUEUE_MASK].state = 0;
+
+	return;
+}
+
+void I2CQueueFast(void)
+{
+	queue[qHead & I2C_QUEUE_MASK].twbr = I2C_TWBR_FAST;
+
+	return;
+}
+
+uint8_t I2CQueueFree(uint8_t bytes)
+{
+	return (uint8_t)(qHead - qTail) < I2C_QUEUE_LEN &&
+		(uint8_t)(ringWr - ringRd) <= I2C_RING_LEN - bytes;
+}
+
+void I2CQueueByte(uint8_t data)
+{
+	I2CWaitQueue(I2C_QUEUE_LEN, I2C_RING_LEN - 1);
+
+	ring[ringWr++ & I2C_RING_MASK] = data;
+	buildLen++;
+
+	return;
+}
+
+// Buffer is sent in place after queued bytes, keep it until transaction is done
+void I2CQueueData(const uint8_t *buf, uint8_t len)
+{
+	queue[qHead & I2C_QUEUE_MASK].xBuf = buf;
+	queue[qHead & I2C_QUEUE_MASK].xLen = len;
+
+	return;
+}
+
+void I2CQueueEnd(void)
+{
+	I2CSubmit();
+
+	return;
+}
+
+void I2CQueueRead(uint8_t *buf, uint8_t len, volatile uint8_t *state)
+{
+	I2CTrans *t = &queue[qHead & I2C_QUEUE_MASK];
+
+	t->rBuf = buf;
+	t->rLen = len;
+	t->state = state;
+	*state = I2C_PENDING;
+
+	I2CSubmit();
+
+	return;
+}
+
+void I2CWait(void)
+{
+	uint8_t i = 0;
+
+	I2CWaitQueue(0, buildLen);
+
+	while (bit_is_set(TWCR, TWSTO)) {				// Wait for last stop
+		if (i++ > 250)								// Avoid endless loop
+			break;
+	}
+
+	return;
+}
@@ -7,6 +7,22 @@
 #define I2C_ACK		1
 #define I2C_READ	1
 
+// Bit rates, prescaler is 1
+#define I2C_TWBR_STD	((F_CPU / 100000 - 16) / 2)		// 100 kHz
+#define I2C_TWBR_FAST	((F_CPU / 400000 - 16) / 2)		// 400 kHz
+
+// Queued transactions, run by TWI interrupt
+#define I2C_QUEUE_LEN	4			// Transactions, power of 2
+#define I2C_RING_LEN	32			// Bytes to write, power of 2, max per transaction
+#define I2C_TIMEOUT		2000		// Wait for queue limit, 10us steps
+
+// Queued transaction state
+enum {
+	I2C_PENDING = 0,
+	I2C_DONE,
+	I2C_FAILED
+};
+
 void I2CInit(void);
 
 void I2CStart(uint8_t addr);
@@ -15,4 +31,14 @@ void I2CStop(void);
 void I2CWriteByte(uint8_t data);
 uint8_t I2CReadByte(uint8_t ack);
 
+void I2CQueueStart(uint8_t addr);
+void I2CQueueFast(void);
+void I2CQueueByte(uint8_t data);
+void I2CQueueData(const uint8_t *buf, uint8_t len);
+void I2CQueueEnd(void);
+void I2CQueueRead(uint8_t *buf, uint8_t len, volatile uint8_t *state);
+
+uint8_t I2CQueueFree(uint8_t bytes);
+void I2CWait(void);
+
 #endif // I2C_H
@@ -3,11 +3,16 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <avr/eeprom.h>
+#include <avr/sleep.h>
+#include <avr/pgmspace.h>
 
 #include "eeprom.h"
+#include "timer.h"
 
 static volatile int8_t encCnt;
-static volatile cmdID cmdBuf;
+static volatile uint8_t cmdBuf[INPUT_CMD_BUF];		// Button commands not taken by main loop
+static volatile uint8_t cmdHead;
+static volatile uint8_t cmdTail;
 static int8_t encRes = 0;
 static uint8_t silenceTime;
 
@@ -15,25 +20,87 @@ static uint8_t silenceTime;
 static volatile uint8_t encPrev = ENC_0;
 static volatile uint8_t btnPrev = BTN_STATE_0;
 
-static volatile uint16_t displayTime;
+static uint32_t rcStamp;							// Time of last IR command
 
-static volatile uint16_t sensTimer;					// Timer of temperature measuring process
-static volatile int16_t stbyTimer = STBY_TIMER_OFF;	// Standby timer
-static volatile int16_t initTimer = INIT_TIMER_OFF;	// Init timer
-static volatile uint16_t secTimer;					// 1 second timer
-static volatile uint8_t clockTimer;
-static volatile int16_t silenceTimer;				// Timer to check silence
-static volatile uint16_t rcTimer;
+static volatile uint16_t events;					// Pending main loop events
 
-static uint8_t rcType;
-static uint8_t rcAddr;
-static uint8_t rcCode[CMD_RC_END];					// Array with rc commands
+// Codes of each remote are sorted for binary search, rcCmd[] keeps their commands
+static uint8_t rcType[RC_REMOTE_COUNT];
+static uint8_t rcAddr[RC_REMOTE_COUNT];
+static uint8_t rcCode[RC_REMOTE_COUNT][CMD_RC_END];
+static uint8_t rcCmd[RC_REMOTE_COUNT][CMD_RC_END];
+static uint8_t rcLearnRemote;						// Remote shown in test mode
+
+// EEPROM type, address and commands array of each remote
+static uint8_t *const rcEeprom[RC_REMOTE_COUNT][3] PROGMEM = {
+	{(uint8_t*)EEPROM_RC_TYPE, (uint8_t*)EEPROM_RC_ADDR, (uint8_t*)EEPROM_RC_CMD},
+	{(uint8_t*)EEPROM_RC2_TYPE, (uint8_t*)EEPROM_RC2_ADDR, (uint8_t*)EEPROM_RC2_CMD},
+};
+
+static uint8_t *rcEepromAddr(uint8_t remote, uint8_t field)
+{
+	return (uint8_t*)pgm_read_word(&rcEeprom[remote][field]);
+}
 
 void rcCodesInit(void)
 {
-	rcType = eeprom_read_byte((uint8_t*)EEPROM_RC_TYPE);
-	rcAddr = eeprom_read_byte((uint8_t*)EEPROM_RC_ADDR);
-	eeprom_read_block(rcCode, (uint8_t*)EEPROM_RC_CMD, CMD_RC_END);
+	uint8_t r, i, j;
+	uint8_t code;
+
+	for (r = 0; r < RC_REMOTE_COUNT; r++) {
+		rcType[r] = eeprom_read_byte(rcEepromAddr(r, 0));
+		rcAddr[r] = eeprom_read_byte(rcEepromAddr(r, 1));
+
+		// Insertion sort keeps lower command first for equal codes
+		for (i = 0; i < CMD_RC_END; i++) {
+			code = eeprom_read_byte(rcEepromAddr(r, 2) + i);
+			for (j = i; j > 0 && rcCode[r][j - 1] > code; j--) {
+				rcCode[r][j] = rcCode[r][j - 1];
+				rcCmd[r][j] = rcCmd[r][j - 1];
+			}
+			rcCode[r][j] = code;
+			rcCmd[r][j] = i;
+		}
+	}
+
+	return;
+}
+
+static uint8_t rcRemote(uint8_t type, uint8_t addr)
+{
+	uint8_t r;
+
+	for (r = 0; r < RC_REMOTE_COUNT; r++)
+		if (type == rcType[r] && addr == rcAddr[r])
+			break;
+
+	return r;
+}
+
+void rcCodeStore(uint8_t cmd, IRData ir)
+{
+	uint8_t r = rcRemote(ir.type, ir.address);
+
+	// Other remote takes free slot or the last one
+	if (r == RC_REMOTE_COUNT) {
+		for (r = 0; r < RC_REMOTE_COUNT - 1; r++)
+			if (rcType[r] >= IR_TYPE_NONE)
+				break;
+		eeprom_update_byte(rcEepromAddr(r, 0), ir.type);
+		eeprom_update_byte(rcEepromAddr(r, 1), ir.address);
+	}
+	eeprom_update_byte(rcEepromAddr(r, 2) + cmd, ir.command);
+	rcLearnRemote = r;
+
+	rcCodesInit();
+
+	return;
+}
+
+void rcCodeShow(uint8_t cmd)
+{
+	setIrData(rcType[rcLearnRemote], rcAddr[rcLearnRemote],
+			  eeprom_read_byte(rcEepromAddr(rcLearnRemote, 2) + cmd));
 
 	return;
 }
@@ -71,23 +138,58 @@ void inputInit(void)
 	silenceTime = eeprom_read_byte((uint8_t*)EEPROM_SILENCE_TIMER);
 
 	encCnt = 0;
-	cmdBuf = CMD_RC_END;
-	sensTimer = 0;
+	cmdHead = cmdTail = 0;
+
+	timerArm(TIMER_POLL, EVENT_POLL_PERIOD);
+	timerArm(TIMER_TUNER, EVENT_TUNER_PERIOD);
+	timerArm(TIMER_BLINK, EVENT_BLINK_PERIOD);
+	timerArm(TIMER_CLOCK, 1000);
 
 	return;
 }
 
-static uint8_t rcCmdIndex(uint8_t cmd)
+static uint8_t rcCmdIndex(uint8_t remote, uint8_t code)
 {
-	uint8_t i;
+	uint8_t *codes = rcCode[remote];
+	uint8_t lo = 0;
+	uint8_t hi = CMD_RC_END;
+	uint8_t mid;
+
+	// Lowest position with code not less than searched one
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (codes[mid] < code)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
 
-	for (i = 0; i < CMD_RC_END; i++)
-		if (cmd == rcCode[i])
-			return i;
+	if (lo < CMD_RC_END && codes[lo] == code)
+		return rcCmd[remote][lo];
 
 	return CMD_RC_END;
 }
 
+// Encoder step by previous and current state, index is (prev << 2) | now
+static const int8_t encStep[16] PROGMEM = {
+	0, 1, -1, 0,
+	-1, 0, 0, 1,
+	1, 0, 0, -1,
+	0, -1, 1, 0,
+};
+
+static void putBtnCmd(cmdID cmd)
+{
+	uint8_t next = (cmdHead + 1) & (INPUT_CMD_BUF - 1);
+
+	if (next != cmdTail) {
+		cmdBuf[cmdHead] = cmd;
+		cmdHead = next;
+	}
+
+	return;
+}
+
 ISR (TIMER2_COMP_vect)
 {
 	static int16_t btnCnt = 0;						// Buttons press duration value
@@ -95,6 +197,7 @@ ISR (TIMER2_COMP_vect)
 	// Current state
 	uint8_t encNow = ENC_0;
 	uint8_t btnNow = BTN_STATE_0;
+	int8_t encOld = encCnt;
 
 	if (encRes) {
 		if (~PIN(ENCODER_A) & ENCODER_A_LINE)
@@ -116,16 +219,7 @@ ISR (TIMER2_COMP_vect)
 
 	// If encoder event has happened, inc/dec encoder counter
 	if (encRes) {
-		if ((encPrev == ENC_0 && encNow == ENC_A) ||
-				(encPrev == ENC_A && encNow == ENC_AB) ||
-				(encPrev == ENC_AB && encNow == ENC_B) ||
-				(encPrev == ENC_B && encNow == ENC_0))
-			encCnt++;
-		if ((encPrev == ENC_0 && encNow == ENC_B) ||
-				(encPrev == ENC_B && encNow == ENC_AB) ||
-				(encPrev == ENC_AB && encNow == ENC_A) ||
-				(encPrev == ENC_A && encNow == ENC_0))
-			encCnt--;
+		encCnt += (int8_t)pgm_read_byte(&encStep[(encPrev << 2) | encNow]);
 		encPrev = encNow;
 	} else {
 		if (~PIN(ENCODER_A) & ENCODER_A_LINE)
@@ -142,25 +236,25 @@ ISR (TIMER2_COMP_vect)
 			if (btnCnt == LONG_PRESS) {
 				switch (btnPrev) {
 				case BTN_1:
-					cmdBuf = CMD_BTN_1_LONG;
+					putBtnCmd(CMD_BTN_1_LONG);
 					break;
 				case BTN_2:
-					cmdBuf = CMD_BTN_2_LONG;
+					putBtnCmd(CMD_BTN_2_LONG);
 					break;
 				case BTN_3:
-					cmdBuf = CMD_BTN_3_LONG;
+					putBtnCmd(CMD_BTN_3_LONG);
 					break;
 				case BTN_4:
-					cmdBuf = CMD_BTN_4_LONG;
+					putBtnCmd(CMD_BTN_4_LONG);
 					break;
 				case BTN_5:
-					cmdBuf = CMD_BTN_5_LONG;
+					putBtnCmd(CMD_BTN_5_LONG);
 					break;
 				case BTN_12:
-					cmdBuf = CMD_BTN_12_LONG;
+					putBtnCmd(CMD_BTN_12_LONG);
 					break;
 				case BTN_13:
-					cmdBuf = CMD_BTN_13_LONG;
+					putBtnCmd(CMD_BTN_13_LONG);
 					break;
 				}
 			} else if (!encRes) {
@@ -183,19 +277,19 @@ ISR (TIMER2_COMP_vect)
 		if ((btnCnt > SHORT_PRESS) && (btnCnt < LONG_PRESS)) {
 			switch (btnPrev) {
 			case BTN_1:
-				cmdBuf = CMD_BTN_1;
+				putBtnCmd(CMD_BTN_1);
 				break;
 			case BTN_2:
-				cmdBuf = CMD_BTN_2;
+				putBtnCmd(CMD_BTN_2);
 				break;
 			case BTN_3:
-				cmdBuf = CMD_BTN_3;
+				putBtnCmd(CMD_BTN_3);
 				break;
 			case BTN_4:
-				cmdBuf = CMD_BTN_4;
+				putBtnCmd(CMD_BTN_4);
 				break;
 			case BTN_5:
-				cmdBuf = CMD_BTN_5;
+				putBtnCmd(CMD_BTN_5);
 				break;
 			}
 			if (!encRes) {
@@ -213,38 +307,11 @@ ISR (TIMER2_COMP_vect)
 	}
 	btnPrev = btnNow;
 
-	// Timer of current display mode
-	if (displayTime)
-		displayTime--;
-
-	// Time from last IR command
-	if (rcTimer < 1000)
-		rcTimer++;
-
-
-	if (secTimer) {
-		secTimer--;
-	} else {
-		secTimer = 1000;
-		// Timer of standby mode
-		if (stbyTimer > 0)
-			stbyTimer--;
-		// Silence timer
-		if (silenceTimer > 0)
-			silenceTimer--;
-		// Timer of temperature measurement
-		if (sensTimer)
-			sensTimer--;
-	}
-
-	// Timer clock update
-	if (clockTimer)
-		clockTimer--;
-
-	// Init timer
-	if (initTimer > 0)
-		initTimer--;
-
+	// Wake up main loop on input and expired timers
+	if (cmdHead != cmdTail || encCnt != encOld)
+		events |= EVENT_INPUT;
+	if (timerTick())
+		events |= EVENT_TIMER;
 
 	return;
 };
@@ -284,8 +351,14 @@ int8_t getEncoder(void)
 
 cmdID getBtnCmd(void)
 {
-	cmdID ret = cmdBuf;
-	cmdBuf = CMD_RC_END;
+	cmdID ret = CMD_RC_END;
+
+	// Commands left in buffer wake up main loop again on next timer tick
+	if (cmdTail != cmdHead) {
+		ret = cmdBuf[cmdTail];
+		cmdTail = (cmdTail + 1) & (INPUT_CMD_BUF - 1);
+	}
+
 	return ret;
 }
 
@@ -295,16 +368,25 @@ cmdID getRcCmd(void)
 	IRData ir = takeIrData();
 
 	uint8_t rcCmdBuf = CMD_RC_END;
-
-	if (ir.ready && (ir.type == rcType) && (ir.address == rcAddr)) {
-		if (!ir.repeat || (rcTimer > 800)) {
-			rcTimer = 0;
-			rcCmdBuf = rcCmdIndex(ir.command);
+	uint8_t remote;
+	uint8_t cmd;
+	uint32_t now;
+
+	if (!ir.ready)
+		return CMD_RC_END;
+
+	remote = rcRemote(ir.type, ir.address);
+	if (remote < RC_REMOTE_COUNT) {
+		cmd = rcCmdIndex(remote, ir.command);
+		now = timerNow();
+		if (!ir.repeat || (now - rcStamp > 800)) {
+			rcStamp = now;
+			rcCmdBuf = cmd;
 		}
-		if (ir.command == rcCode[CMD_RC_VOL_UP] || ir.command == rcCode[CMD_RC_VOL_DOWN]) {
-			if (rcTimer > 400) {
-				rcTimer = 360;
-				rcCmdBuf = rcCmdIndex(ir.command);
+		if (cmd == CMD_RC_VOL_UP || cmd == CMD_RC_VOL_DOWN) {
+			if (now - rcStamp > 400) {
+				rcStamp = now - 360;
+				rcCmdBuf = cmd;
 			}
 		}
 	}
@@ -324,94 +406,126 @@ uint16_t getEncBuf(void)
 
 void setDisplayTime(uint16_t value)
 {
-	displayTime = value;
+	timerArm(TIMER_DISPLAY, value);
 
 	return;
 }
 
 uint16_t getDisplayTime(void)
 {
-	return displayTime;
+	int32_t left = timerLeft(TIMER_DISPLAY);
+
+	return left > 0 ? left : 0;
 }
 
-uint8_t getSensTimer(void)
+// Seconds timers are rounded up, so 0 means expired
+static int16_t timerLeftSec(uint8_t timer)
 {
-	return sensTimer;
+	int32_t left = timerLeft(timer);
+
+	if (left == TIMER_LEFT_OFF)
+		return STBY_TIMER_OFF;
+
+	return (left + 999) / 1000;
 }
 
 void setSensTimer(uint8_t val)
 {
-	sensTimer = val;
+	if (val)
+		timerArm(TIMER_SENS, val * 1000UL);
+	else
+		timerCancel(TIMER_SENS);
 
 	return;
 }
 
 int16_t getStbyTimer(void)
 {
-	return stbyTimer;
+	return timerLeftSec(TIMER_STBY);
 }
 
 void setStbyTimer(int16_t val)
 {
-	stbyTimer = val;
+	if (val == STBY_TIMER_OFF)
+		timerCancel(TIMER_STBY);
+	else
+		timerArm(TIMER_STBY, val * 1000UL);
 
 	return;
 }
 
-void setSecTimer(uint16_t val)
+// Called from interrupts only
+void setEvent(uint16_t event)
 {
-	secTimer = val;
+	events |= event;
 
 	return;
 }
 
-int16_t getSecTimer(void)
+// RAM clock second begins now
+void resetClockPhase(void)
 {
-	return secTimer;
-}
-
-void setClockTimer(uint8_t value)
-{
-	clockTimer = value;
+	timerArm(TIMER_CLOCK, 1000);
+	cli();
+	events &= ~EVENT_TIME;
+	sei();
 
 	return;
 }
 
-uint8_t getClockTimer(void)
+// Sleep until any event and take them
+uint16_t waitEvents(void)
 {
-	return clockTimer;
+	uint16_t ret;
+
+	cli();
+	while (!events) {
+		sleep_enable();
+		sei();
+		sleep_cpu();						// Any interrupt wakes up
+		sleep_disable();
+		cli();
+	}
+	ret = events;
+	events = 0;
+	sei();
+
+	return ret;
 }
 
 void enableSilenceTimer(void)
 {
 	if (silenceTime)
-		silenceTimer = 60 * silenceTime;
+		timerArm(TIMER_SILENCE, 60000UL * silenceTime);
 	else
-		silenceTimer = STBY_TIMER_OFF;
+		timerCancel(TIMER_SILENCE);
 
 	return;
 }
 
 int16_t getSilenceTimer(void)
 {
-	return silenceTimer;
+	return timerLeftSec(TIMER_SILENCE);
 }
 
 void disableSilenceTimer(void)
 {
-	silenceTimer = STBY_TIMER_OFF;
+	timerCancel(TIMER_SILENCE);
 
 	return;
 }
 
 void setInitTimer(int16_t value)
 {
-	initTimer = value;
+	if (value == INIT_TIMER_OFF)
+		timerCancel(TIMER_INIT);
+	else
+		timerArm(TIMER_INIT, value);
 
 	return;
 }
 
 int16_t getInitTimer(void)
 {
-	return initTimer;
+	return timerLeft(TIMER_INIT);
 }
@@ -82,6 +82,12 @@ typedef enum {
 
 } cmdID;
 
+// Remotes with own command tables, see EEPROM_RC_CMD and EEPROM_RC2_CMD
+#define RC_REMOTE_COUNT			2
+
+// Button commands buffered for main loop, power of 2
+#define INPUT_CMD_BUF			8
+
 // Handling long press actions
 #define SHORT_PRESS				100
 #define LONG_PRESS				600
@@ -96,7 +102,27 @@ typedef enum {
 #define TEMP_MEASURE_TIME		1
 #define SENSOR_POLL_INTERVAL	5
 
+// Main loop events, see waitEvents()
+#define EVENT_INPUT				(1<<0)		// Button, encoder, RC or UART command
+#define EVENT_POLL				(1<<1)		// Timers and display mode check
+#define EVENT_TIME				(1<<2)		// Second of RAM clock has passed
+#define EVENT_TUNER				(1<<3)		// Tuner status read
+#define EVENT_BLINK				(1<<4)		// Edit and test screens refresh
+#define EVENT_TEMP				(1<<5)		// Temperature sensors poll
+#define EVENT_SPECTRUM			(1<<6)		// ADC buffers are ready for FFT
+#define EVENT_RC				(1<<7)		// IR remote edges to decode
+#define EVENT_TIMER				(1<<8)		// Some timer has expired, see timerProcess()
+#define EVENT_UART				(1<<9)		// UART bytes to parse
+#define EVENT_STREAM			(1<<10)		// UART telemetry frame is due
+
+// Periods of timed events, ms
+#define EVENT_POLL_PERIOD		10
+#define EVENT_TUNER_PERIOD		50
+#define EVENT_BLINK_PERIOD		100
+
 void rcCodesInit(void);
+void rcCodeStore(uint8_t cmd, IRData ir);
+void rcCodeShow(uint8_t cmd);
 void inputInit(void);
 
 int8_t getEncoder(void);
@@ -109,17 +135,14 @@ uint16_t getEncBuf(void);
 void setDisplayTime(uint16_t value);
 uint16_t getDisplayTime(void);
 
-uint8_t getSensTimer(void);
 void setSensTimer(uint8_t val);
 
 int16_t getStbyTimer(void);
 void setStbyTimer(int16_t val);
 
-void setSecTimer(uint16_t val);
-int16_t getSecTimer(void);
-
-void setClockTimer(uint8_t value);
-uint8_t getClockTimer(void);
+void setEvent(uint16_t event);
+void resetClockPhase(void);
+uint16_t waitEvents(void);
 
 void enableSilenceTimer(void);
 void disableSilenceTimer(void);
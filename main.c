@@ -1,9 +1,11 @@
 #include <avr/interrupt.h>
 #include <avr/eeprom.h>
+#include <avr/sleep.h>
 
 #include "eeprom.h"
 #include "adc.h"
 #include "input.h"
+#include "timer.h"
 #include "remote.h"
 #include "uart.h"
 #include "i2c.h"
@@ -39,12 +41,17 @@ static void hwInit(void)
 
 	tunerInit();							// Tuner
 
+	rtcReadTime();							// RAM clock, resynced on RTC seconds edge
+	rtcSync(0);
+
 	DDR(STMU_STBY) |= STMU_STBY_LINE;		// Standby port
 	DDR(STMU_MUTE) |= STMU_MUTE_LINE;		// Mute port
 	sndInit();								// Load labels/icons/etc
 
 	setStbyTimer(0);
 
+	set_sleep_mode(SLEEP_MODE_IDLE);		// Wait for events in idle mode
+
 	return;
 }
 
@@ -52,41 +59,78 @@ int main(void)
 {
 	int8_t encCnt = 0;
 	uint8_t action = ACTION_NOACTION;
+	uint16_t events;
+	uint8_t redraw = 1;
 
 	// Init hardware
 	hwInit();
 
 	while (1) {
+		// Sleep until interrupts bring some work
+		events = waitEvents();
+
+		// Expired timers raise their events
+		if (events & EVENT_TIMER)
+			events |= timerProcess();
+
 		// Control temperature
 		if (extFunc == USE_DS18B20) {
-			if (getSensTimer() == 0) {
+			if (events & EVENT_TEMP) {
 				ds18x20Process();
 				setSensTimer(SENSOR_POLL_INTERVAL);
 			}
-			tempControlProcess();
+			if (events & EVENT_POLL)
+				tempControlProcess();
 		}
 
-		// Emulate poweroff if any of timers expired
-		if (getStbyTimer() == 0 || getSilenceTimer() == 0)
-			action = CMD_RC_STBY;
+		// Update spectrum data from ready ADC buffers
+		if (events & EVENT_SPECTRUM)
+			getSpectrum();
+
+		if (events & EVENT_POLL) {
+			// Emulate poweroff if any of timers expired
+			if (getStbyTimer() == 0 || getSilenceTimer() == 0)
+				action = CMD_RC_STBY;
+
+			// Init hardware if init timer expired
+			if (getInitTimer() == 0)
+				action = ACTION_INIT_HARDWARE;
+		}
+
+		// Advance RAM clock and check alarm
+		if (events & EVENT_TIME) {
+			rtcTick();
+			if (action == ACTION_NOACTION)
+				action = checkAlarmAndTime();
+		}
 
-		// Init hardware if init timer expired
-		if (getInitTimer() == 0)
-			action = ACTION_INIT_HARDWARE;
+		// Follow RTC chip while resync is running
+		if ((events & EVENT_POLL) && rtcSyncPoll())
+			events |= EVENT_TIME;
 
-		// Check alarm and update time
-		if (action == ACTION_NOACTION)
-			action = checkAlarmAndTime();
+		// Decode IR remote edges buffered by interrupt
+		if ((events & EVENT_RC) && rcProcess())
+			events |= EVENT_INPUT;
 
-		// Convert input command to action
-		if (action == ACTION_NOACTION)
-			action = getAction();
+		// Parse UART bytes, poll takes ones left after previous frame
+		if ((events & (EVENT_UART | EVENT_POLL)) && uartProcess())
+			events |= EVENT_INPUT;
+
+		if (events & EVENT_INPUT) {
+			// Convert input command to action
+			if (action == ACTION_NOACTION)
+				action = getAction();
+
+			// Handle encoder
+			encCnt = getEncoder();			// Get value from encoder
+			redraw = 1;
+		}
 
 		// Handle action
+		if (action != ACTION_NOACTION)
+			redraw = 1;
 		handleAction(action);
 
-		// Handle encoder
-		encCnt = getEncoder();				// Get value from encoder
 		if (action == CMD_RC_VOL_UP)		// Emulate VOLUME_UP action as encoder action
 			encCnt++;
 		if (action == CMD_RC_VOL_DOWN)		// Emulate VOLUME_DOWN action as encoder action
@@ -99,18 +143,35 @@ int main(void)
 
 		// Reset handled action
 		action = ACTION_NOACTION;
+		encCnt = 0;
+
+		// Send telemetry if PC has subscribed
+		if (events & EVENT_STREAM)
+			handleStream();
 
-		// Check if we need exit to default mode
-		handleExitDefaultMode();
+		if (events & EVENT_POLL) {
+			// Check if we need exit to default mode
+			handleExitDefaultMode();
 
-		// Switch to timer mode if it expires
-		handleTimers();
+			// Switch to timer mode if it expires
+			handleTimers();
+
+			// Next step of FM band scan
+			handleFmScan();
+
+			// Write changed settings while EEPROM is idle
+			eepromCommitStep();
+		}
 
 		// Clear screen if mode has changed
-		handleModeChange();
+		if (handleModeChange())
+			redraw = 1;
 
-		// Show things
-		showScreen();
+		// Show things only if they could change
+		if (redraw || (events & screenEvents())) {
+			showScreen();
+			redraw = 0;
+		}
 	}
 
 	return 0;
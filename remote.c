@@ -1,12 +1,40 @@
 #include "remote.h"
+#include "input.h"
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
 
-static volatile IRData irData;						// Last decoded IR command
+static IRData irData;								// Last decoded IR command
 static volatile uint8_t ovfCnt = 250;				// Overflow counter
 
+// Edges timestamped by INT1: level time in timer ticks and RC_EDGE_MARK
+static volatile uint16_t edgeBuf[RC_EDGE_BUF];
+static volatile uint8_t edgeHead;
+static volatile uint8_t edgeTail;
+
+static const RCBiphase biphase[] PROGMEM = {
+	{IR_TYPE_RC5, RC_TICKS(RC5_UNIT), 0, 0, 14, RC_BIPHASE_NONE, 0},
+	{IR_TYPE_RC6, RC_TICKS(RC6_UNIT), RC6_LEAD_MARK, RC6_LEAD_SPACE, 21, 4, 1},
+};
+#define RC_BIPHASE_END		(sizeof(biphase) / sizeof(biphase[0]))
+
+static const RCPulse pulse[] PROGMEM = {
+	{IR_TYPE_NEC, RC_TICKS(NEC_INIT), RC_TICKS(NEC_START), RC_TICKS(NEC_REPEAT),
+	 RC_TICKS(NEC_PULSE), RC_TICKS(NEC_ZERO), RC_TICKS(NEC_ONE)},
+	{IR_TYPE_SAM, RC_TICKS(SAM_INIT), RC_TICKS(NEC_START), RC_TICKS(NEC_REPEAT),
+	 RC_TICKS(NEC_PULSE), RC_TICKS(NEC_ZERO), RC_TICKS(NEC_ONE)},
+};
+#define RC_PULSE_END		(sizeof(pulse) / sizeof(pulse[0]))
+
+static RCBiphaseDecoder biDec[RC_BIPHASE_END];
+static uint8_t biTogOld;
+
+static RCPulseState pdState = STATE_PULSE_IDLE;
+static uint8_t pdProto;
+static uint8_t pdCnt;
+static NECCmd pdCmd;
+
 void rcInit(void)
 {
 	MCUCR |= (1<<ISC10);							// Set INT1 to trigger on any edge
@@ -31,221 +59,236 @@ ISR(TIMER1_OVF_vect)								// Overflow every 1/(250kHz/65536) = 262ms
 ISR(INT1_vect)
 {
 	static uint16_t tcnt = 0;
-	uint16_t delay = TCNT1 - tcnt;					// Delay since previous interrupt
+	uint16_t delay = TCNT1 - tcnt;					// Time of level ended by this edge
+	uint8_t head = edgeHead;
+	uint8_t next = (head + 1) & (RC_EDGE_BUF - 1);
 
 	tcnt = TCNT1;
 
-	// RC pin state on interrupt event is inverted due to inverted IR receiver polarity
-	uint8_t rcPin = !(PIN(RC) & RC_LINE);
-
-	// NEC protocol variables
-	static uint8_t necCnt = 0;						// NEC bit counter
-	static NECCmd necCmd;							// NEC command
-	static NECState necState = STATE_NEC_IDLE;		// NEC decoding state
-
-	// RC5/RC6 protocol variables
-	static uint8_t rc5Cnt = 16;						// RC5 bit counter
-	static uint16_t rc5Cmd = 0;						// RC5 command
-	static RC5State rc5State = STATE_RC5_START1;	// RC5 decoding state
-	static int8_t rc6Cnt = 0;						// RC6 bit counter
-	static uint16_t rc6Cmd = 0;						// RC6 command
-	static RC5State rc6State = STATE_RC5_START1;	// RC6 decoding state
-
-	static uint8_t rc6TogBitOld = 0;
-	uint8_t rc6TogBit = 0;
-
-	if (rcPin) {
-		// Try to decode as RC6 sequence
-		if (RC6_NEAR(delay, RC6_2T)) {
-			if (rc5State == STATE_RC5_START1) {
-				rc5State = STATE_RC5_MID1;
-				rc5Cnt--;
-				rc5Cmd <<= 1;
-				rc5Cmd |= 0x01;
-			} else if (rc5State == STATE_RC5_MID0) {
-				rc5State = STATE_RC5_START0;
-			}
-			if (rc6State == STATE_RC5_MID1) {
-				if (rc6Cnt == 21 || rc6Cnt == 16) {
-					rc6State = STATE_RC5_START1;
-				} else {
-					rc6State = STATE_RC5_MID0;
-					if (--rc6Cnt < 16)
-						rc6Cmd <<= 1;
-				}
-			} else if (rc6State == STATE_RC5_START0) {
-				if (rc6Cnt == 17) {
-					rc6State = STATE_RC5_MID0;
-					--rc6Cnt;
-					rc6TogBit = 0;
-				}
-			}
-		} else if (RC6_NEAR(delay, RC6_4T)) {
-			if (rc5State == STATE_RC5_MID0) {
-				rc5State = STATE_RC5_MID1;
-				rc5Cnt--;
-				rc5Cmd <<= 1;
-				rc5Cmd |= 0x01;
-			}
-		} else if (RC6_NEAR(delay, RC6_1T)) {
-			rc5Cnt = 13;								// Reset
-			rc5State = STATE_RC5_MID1;
-			if (rc6State == STATE_RC5_START0) {
-				rc6State = STATE_RC5_MID0;
-				if (--rc6Cnt < 16)
-					rc6Cmd <<= 1;
-			} else if (rc6State == STATE_RC5_MID1) {
-				rc6State = STATE_RC5_START1;
-			}
-		} else if (RC6_NEAR(delay, RC6_3T)) {
-			rc5Cnt = 13;								// Reset
-			rc5State = STATE_RC5_MID1;
-			if (rc6State == STATE_RC5_MID1) {
-				if (rc6Cnt == 17) {
-					rc6State = STATE_RC5_MID0;
-					--rc6Cnt;
-					rc6TogBit = 0;
-				} else if (rc6Cnt == 21 || rc6Cnt == 16) {
-					rc6State = STATE_RC5_MID0;
-					if (--rc6Cnt < 16) {
-						rc6Cmd <<= 1;
-					}
-				}
-			}
-		} else {
-			rc5Cnt = 13;								// Reset
-			rc5State = STATE_RC5_MID1;
-			rc6Cnt = 22;								// Reset
-			rc6State = STATE_RC5_START1;
+	if (delay > RC_EDGE_TIME)
+		delay = RC_EDGE_TIME;
+	// RC pin is inverted due to inverted IR receiver polarity, so high level is a pause
+	if (PIN(RC) & RC_LINE)
+		delay |= RC_EDGE_MARK;
+
+	// If main loop is late, edge is lost and decoders wait for next leader
+	if (next != edgeTail) {
+		edgeBuf[head] = delay;
+		edgeHead = next;
+	}
+
+	setEvent(EVENT_RC);
+
+	return;
+}
+
+// Feeds n half-bit times of one level, bit value is taken on the edge in its middle
+static RCBiphaseState rcBiphaseLevel(const RCBiphase *p, RCBiphaseDecoder *dec, uint8_t mark, uint16_t n)
+{
+	uint8_t width;
+
+	while (n--) {
+		width = (dec->bit == p->wideBit ? 2 : 1);
+		if (dec->half == 0)
+			dec->first = mark;
+		if ((dec->half < width) != (mark == dec->first))
+			return STATE_BIPHASE_IDLE;
+		if (++dec->half == width) {
+			if (n)
+				return STATE_BIPHASE_IDLE;
+			dec->data <<= 1;
+			if (dec->first == p->one)
+				dec->data |= 0x01;
+			if (dec->bit + 1 == p->bits)
+				return STATE_BIPHASE_DONE;
+		} else if (dec->half == 2 * width) {
+			dec->half = 0;
+			dec->bit++;
 		}
+	}
 
-		// Try to decode as NEC sequence
-		if (necState == STATE_NEC_INIT) {
-			if (NEC_NEAR(delay, NEC_START)) {
-				necState = STATE_NEC_RECEIVE;
-			} else if (NEC_NEAR(delay, NEC_REPEAT) && ovfCnt < 2) {
-				irData.repeat = 1;
-				irData.ready = 1;
-				ovfCnt = 0;
-			}
-			necCnt = 0;
-		} else if (necState == STATE_NEC_RECEIVE) {
-			necCnt++;
-			necCmd.raw >>= 1;
-			if (NEC_NEAR(delay, NEC_ZERO))
-				necCmd.raw &= ~0x80000000;
-			else if (NEC_NEAR(delay, NEC_ONE))
-				necCmd.raw |= 0x80000000;
-			else
-				necCnt = 0;
-			if (necCnt == 32) {
-				if ((uint8_t)(~necCmd.ncmd) == necCmd.cmd) {
-					irData.ready = 1;
-					if (ovfCnt < 2)
-						irData.repeat = 1;
-					else
-						irData.repeat = 0;
-					irData.address = necCmd.laddr;
-					irData.command = necCmd.cmd;
-					ovfCnt = 0;
-				}
-			}
+	return STATE_BIPHASE_DATA;
+}
+
+static uint8_t rcBiphaseNear(uint16_t value, uint16_t time)
+{
+	uint16_t dev = time / RC_BIPHASE_DEV;
+
+	return (value > time - dev && value < time + dev);
+}
+
+static uint8_t rcBiphase(const RCBiphase *pgm, RCBiphaseDecoder *dec, uint8_t mark, uint16_t delay)
+{
+	RCBiphase p;
+	uint16_t n;
+
+	memcpy_P(&p, pgm, sizeof(RCBiphase));
+
+	// Level time in half-bit times
+	n = (delay + p.unit / 2) / p.unit;
+	if (!rcBiphaseNear(delay, n * p.unit))
+		n = 0;
+
+	if (dec->state == STATE_BIPHASE_DATA && n) {
+		dec->state = rcBiphaseLevel(&p, dec, mark, n);
+		if (dec->state == STATE_BIPHASE_DONE) {
+			dec->state = STATE_BIPHASE_IDLE;
+			return 1;
+		}
+		if (dec->state == STATE_BIPHASE_DATA)
+			return 0;
+	} else if (dec->state == STATE_BIPHASE_LEAD) {
+		dec->state = STATE_BIPHASE_IDLE;
+		if (!mark && rcBiphaseNear(delay, p.leadSpace * p.unit)) {
+			dec->state = STATE_BIPHASE_DATA;
+			dec->bit = 0;
+			dec->half = 0;
+			dec->data = 0;
 		}
+		return 0;
+	}
+
+	// Burst may start a new frame
+	dec->state = STATE_BIPHASE_IDLE;
+	if (!mark)
+		return 0;
+	if (p.leadMark) {
+		if (rcBiphaseNear(delay, p.leadMark * p.unit))
+			dec->state = STATE_BIPHASE_LEAD;
+		return 0;
+	}
+	if (n == 0)
+		return 0;
+
+	// No leader: first half of start bit is a pause before frame
+	dec->bit = 0;
+	dec->half = 1;
+	dec->first = 0;
+	dec->data = !p.one;
+	dec->state = rcBiphaseLevel(&p, dec, mark, n);
+	if (dec->state != STATE_BIPHASE_DATA)
+		dec->state = STATE_BIPHASE_IDLE;
+
+	return 0;
+}
+
+static void rcBiphaseDone(uint8_t type, uint32_t data)
+{
+	uint8_t togBit;
+
+	irData.type = type;
+	if (type == IR_TYPE_RC5) {
+		togBit = (data & RC5_TOGB_MASK) != 0;
+		irData.address = (data & RC5_ADDR_MASK) >> 6;
+		irData.command = (data & RC5_COMM_MASK) | (data & RC5_FIBT_MASK ? 0x00 : 0x40);
 	} else {
-		// Try to decode as RC6 sequence
-		if (RC6_NEAR(delay, RC6_2T)) {
-			if (rc6State == STATE_RC5_MID0) {
-				if (rc6Cnt == 16) {
-					rc6State = STATE_RC5_START0;
-				} else {
-					rc6State = STATE_RC5_MID1;
-					if (--rc6Cnt < 16) {
-						rc6Cmd <<= 1;
-						rc6Cmd |= 0x01;
-					}
-				}
-			} else if (rc6State == STATE_RC5_START1) {
-				if (rc6Cnt == 17) {
-					rc6State = STATE_RC5_MID1;
-					--rc6Cnt;
-					rc6TogBit = 1;
-				}
-			}
-			if (rc5State == STATE_RC5_MID1) {
-				rc5State = STATE_RC5_START1;
-			} else if (rc5State == STATE_RC5_START0) {
-				rc5State = STATE_RC5_MID0;
-				rc5Cnt--;
-				rc5Cmd <<= 1;
-			}
-		} else if (RC6_NEAR(delay, RC6_4T)) {
-			if (rc5State == STATE_RC5_MID1) {
-				rc5State = STATE_RC5_MID0;
-				rc5Cnt--;
-				rc5Cmd <<= 1;
-			}
-		} else if (RC6_NEAR(delay, RC6_1T)) {
-			if (rc6State == STATE_RC5_START1) {
-				rc6State = STATE_RC5_MID1;
-				if (--rc6Cnt < 16) {
-					rc6Cmd <<= 1;
-					rc6Cmd |= 0x01;
-				}
-			} else if (rc6State == STATE_RC5_MID0) {
-				rc6State = STATE_RC5_START0;
-			}
-		} else if (RC6_NEAR(delay, RC6_3T)) {
-			if (rc6State == STATE_RC5_MID0) {
-				if (rc6Cnt == 17) {
-					rc6State = STATE_RC5_MID1;
-					--rc6Cnt;
-					rc6TogBit = 1;
-				} else if (rc6Cnt == 16) {
-					rc6State = STATE_RC5_MID1;
-					rc6Cmd <<= 1;
-					rc6Cmd |= 0x01;
-				}
+		togBit = (data & RC6_TOGB_MASK) != 0;
+		irData.address = (data & RC6_ADDR_MASK) >> 8;
+		irData.command = data & RC6_COMM_MASK;
+	}
+	irData.ready = 1;
+	irData.repeat = (togBit == biTogOld);
+	biTogOld = togBit;
+
+	return;
+}
+
+static uint8_t rcPulseNear(uint16_t value, const uint16_t *time)
+{
+	uint16_t t = pgm_read_word(time);
+
+	return (value > t - RC_PULSE_DEV(t) && value < t + RC_PULSE_DEV(t));
+}
+
+static void rcPulse(uint8_t mark, uint16_t delay)
+{
+	const RCPulse *p = &pulse[pdProto];
+	uint8_t i;
+
+	switch (pdState) {
+	case STATE_PULSE_LEAD:
+		pdState = STATE_PULSE_IDLE;
+		if (mark)
+			break;
+		if (rcPulseNear(delay, &p->leadSpace)) {
+			pdState = STATE_PULSE_MARK;
+			pdCnt = 0;
+		} else if (rcPulseNear(delay, &p->repSpace) && ovfCnt < 2) {
+			irData.type = pgm_read_byte(&p->type);
+			irData.repeat = 1;
+			irData.ready = 1;
+			ovfCnt = 0;
+		}
+		return;
+	case STATE_PULSE_MARK:
+		if (mark && rcPulseNear(delay, &p->bitMark)) {
+			pdState = STATE_PULSE_SPACE;
+			return;
+		}
+		break;
+	case STATE_PULSE_SPACE:
+		if (mark)
+			break;
+		pdCmd.raw >>= 1;
+		if (rcPulseNear(delay, &p->oneSpace))
+			pdCmd.raw |= 0x80000000;
+		else if (!rcPulseNear(delay, &p->zeroSpace))
+			break;
+		pdState = STATE_PULSE_MARK;
+		if (++pdCnt == NEC_BITS) {
+			pdState = STATE_PULSE_IDLE;
+			if ((uint8_t)(~pdCmd.ncmd) == pdCmd.cmd) {
+				irData.type = pgm_read_byte(&p->type);
+				irData.ready = 1;
+				irData.repeat = (ovfCnt < 2);
+				irData.address = pdCmd.laddr;
+				irData.command = pdCmd.cmd;
+				ovfCnt = 0;
 			}
-		} else if (RC6_NEAR(delay, RC6_6T)) {
-			rc6State = STATE_RC5_MID1;
-			rc6Cnt = 21;
-		} else {
-			rc6Cnt = 22;								// Reset
-			rc6State = STATE_RC5_START1;
 		}
+		return;
+	default:
+		break;
+	}
 
-		// Try to decode as NEC sequence
-		if (NEC_NEAR(delay, NEC_PULSE) && necState != STATE_NEC_REPEAT) {
-			necState = STATE_NEC_RECEIVE;
-		} else if (NEC_NEAR(delay, NEC_INIT)) {
-			necState = STATE_NEC_INIT;
-			irData.type = IR_TYPE_NEC;
-		} else if (NEC_NEAR(delay, SAM_INIT)) {
-			necState = STATE_NEC_INIT;
-			irData.type = IR_TYPE_SAM;
-		} else {
-			necState = STATE_NEC_IDLE;
+	// Burst may start a new frame
+	pdState = STATE_PULSE_IDLE;
+	if (!mark)
+		return;
+	for (i = 0; i < RC_PULSE_END; i++) {
+		if (rcPulseNear(delay, &pulse[i].leadMark)) {
+			pdState = STATE_PULSE_LEAD;
+			pdProto = i;
+			break;
 		}
 	}
 
-	if (rc5Cnt == 0 || rc6Cnt == 0) {
-		if (rc5Cnt == 0) {
-			rc6TogBit = (rc5Cmd & RC5_TOGB_MASK) != 0;
-			irData.type = IR_TYPE_RC5;
-			irData.address  = (rc5Cmd & RC5_ADDR_MASK) >> 6;
-			irData.command = (rc5Cmd & RC5_COMM_MASK) | (rc5Cmd & RC5_FIBT_MASK ? 0x00 : 0x40);
-		} else {
-			irData.type = IR_TYPE_RC6;
-			irData.address  = (rc6Cmd & RC6_ADDR_MASK) >> 8;
-			irData.command = rc6Cmd & RC6_COMM_MASK;
+	return;
+}
+
+uint8_t rcProcess(void)
+{
+	uint8_t tail = edgeTail;
+	uint16_t edge, delay;
+	uint8_t mark;
+	uint8_t i;
+
+	while (tail != edgeHead) {
+		edge = edgeBuf[tail];
+		tail = (tail + 1) & (RC_EDGE_BUF - 1);
+		edgeTail = tail;
+
+		mark = (edge & RC_EDGE_MARK) != 0;
+		delay = edge & RC_EDGE_TIME;
+
+		for (i = 0; i < RC_BIPHASE_END; i++) {
+			if (rcBiphase(&biphase[i], &biDec[i], mark, delay))
+				rcBiphaseDone(pgm_read_byte(&biphase[i].type), biDec[i].data);
 		}
-		rc6Cnt = 22;
-		rc5Cnt = 13;
-		irData.ready = 1;
-		irData.repeat = (rc6TogBit == rc6TogBitOld);
-		rc6TogBitOld = rc6TogBit;
+		rcPulse(mark, delay);
 	}
-	return;
+
+	return irData.ready;
 }
 
 IRData takeIrData()
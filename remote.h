@@ -6,18 +6,16 @@
 
 // Time scale definitions and macroses
 #define RC_TIMER_DIV				4	// 1MHz / 250kHz of Timer 1 => delays in us
+#define RC_TICKS(delay)				((delay) / RC_TIMER_DIV)
 
-#define NEC_DEV_MIN					0.7
-#define NEC_DEV_MAX					1.3
-#define NEC_MIN(delay)				((uint16_t)(delay / RC_TIMER_DIV * NEC_DEV_MIN))
-#define NEC_MAX(delay)				((uint16_t)(delay / RC_TIMER_DIV * NEC_DEV_MAX))
-#define NEC_NEAR(value, delay)		(value > NEC_MIN(delay) && value < NEC_MAX(delay))
+// Edges are timestamped by INT1 and decoded in main loop
+#define RC_EDGE_BUF					32			// Power of 2
+#define RC_EDGE_MARK				0x8000		// Level ended by edge was IR burst
+#define RC_EDGE_TIME				0x7FFF		// Longer levels are cut to this
 
-#define RC6_DEV_MIN					0.8
-#define RC6_DEV_MAX					1.2
-#define RC6_MIN(delay)				((uint16_t)(delay / RC_TIMER_DIV * RC6_DEV_MIN))
-#define RC6_MAX(delay)				((uint16_t)(delay / RC_TIMER_DIV * RC6_DEV_MAX))
-#define RC6_NEAR(value, delay)		(value > RC6_MIN(delay) && value < RC6_MAX(delay))
+// Pulse-distance (NEC/Samsung) times may differ by 30%, bi-phase (RC5/RC6) by 20%
+#define RC_PULSE_DEV(time)			((time) / 10 * 3)
+#define RC_BIPHASE_DEV				5			// 1/5 of half-bit time
 
 // Remote control types
 enum {
@@ -41,27 +39,47 @@ typedef struct {
 } IRData;
 
 // RC5/RC6 definitions
-#define RC6_1T						444
-#define RC6_2T						889
-#define RC6_3T						1333
-#define RC6_4T						1778
-#define RC6_6T						2667
+#define RC5_UNIT					889			// Half-bit time
+#define RC6_UNIT					444
 
-#define RC5_STBT_MASK				0x2000
 #define RC5_FIBT_MASK				0x1000
 #define RC5_TOGB_MASK				0x0800
 #define RC5_ADDR_MASK				0x07C0
 #define RC5_COMM_MASK				0x003F
 
-#define RC6_ADDR_MASK				0xFFC0
+#define RC6_LEAD_MARK				6			// Leader in half-bit times
+#define RC6_LEAD_SPACE				2
+#define RC6_TOGB_MASK				0x00010000	// Trailer bit
+#define RC6_ADDR_MASK				0xFF00
 #define RC6_COMM_MASK				0x00FF
 
+#define RC_BIPHASE_NONE				0xFF
+
+// Bi-phase protocol description, stored in flash
+typedef struct {
+	uint8_t type;
+	uint8_t unit;								// Half-bit time, timer ticks
+	uint8_t leadMark;							// Leader in half-bit times, 0 - no leader
+	uint8_t leadSpace;
+	uint8_t bits;								// Bits in frame including start bit
+	uint8_t wideBit;							// Bit with double time (RC6 trailer)
+	uint8_t one;								// Level of first half of '1' bit
+} RCBiphase;
+
 typedef enum {
-	STATE_RC5_MID0 = 0,
-	STATE_RC5_MID1,
-	STATE_RC5_START0,
-	STATE_RC5_START1,
-} RC5State;
+	STATE_BIPHASE_IDLE = 0,
+	STATE_BIPHASE_LEAD,
+	STATE_BIPHASE_DATA,
+	STATE_BIPHASE_DONE,
+} RCBiphaseState;
+
+typedef struct {
+	RCBiphaseState state;
+	uint8_t bit;								// Bits received
+	uint8_t half;								// Half-bit times of current bit received
+	uint8_t first;								// Level of first half of current bit
+	uint32_t data;
+} RCBiphaseDecoder;
 
 // NEC/Samsung definitions
 #define NEC_INIT					9000
@@ -71,13 +89,25 @@ typedef enum {
 #define NEC_ZERO					560
 #define NEC_ONE						1680
 #define NEC_PULSE					560
+#define NEC_BITS					32
+
+// Pulse-distance protocol description, stored in flash, times in timer ticks
+typedef struct {
+	uint8_t type;
+	uint16_t leadMark;
+	uint16_t leadSpace;
+	uint16_t repSpace;							// Leader space of repeat frame
+	uint16_t bitMark;
+	uint16_t zeroSpace;
+	uint16_t oneSpace;
+} RCPulse;
 
 typedef enum {
-	STATE_NEC_IDLE = 0,
-	STATE_NEC_INIT,
-	STATE_NEC_REPEAT,
-	STATE_NEC_RECEIVE,
-} NECState;
+	STATE_PULSE_IDLE = 0,
+	STATE_PULSE_LEAD,
+	STATE_PULSE_MARK,
+	STATE_PULSE_SPACE,
+} RCPulseState;
 
 typedef union {
 	uint32_t raw;
@@ -90,6 +120,7 @@ typedef union {
 } NECCmd;
 
 void rcInit(void);
+uint8_t rcProcess(void);
 
 IRData takeIrData(void);
 IRData getIrData(void);
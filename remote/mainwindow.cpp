@@ -4,14 +4,61 @@
 #include <QMessageBox>
 #include <QtDebug>
 
+// Frame protocol, see uart.h of firmware
+enum {
+    UART_SYNC = 0xA5,
+    UART_REPLY = 0x80,
+
+    UART_CMD_RC = 0x00,
+    UART_CMD_STREAM = 0x07,
+    UART_CMD_TELEMETRY = 0x0E,
+
+    UART_OK = 0,
+
+    UART_STREAM_BINS = 16,
+    UART_STREAM_LEN = UART_STREAM_BINS + 7,     // With status
+};
+
+// Firmware display modes, actions.h
+static const char *modeNames[] = {
+    "Volume", "Bass", "Middle", "Treble", "Preamp", "Front/rear", "Balance",
+    "Center", "Subwoofer", "Gain 0", "Gain 1", "Gain 2", "Gain 3", "Gain 4",
+    "Spectrum", "Standby", "FM radio", "FM tune", "Time", "Time edit",
+    "Timer", "Silence timer", "Alarm", "Alarm edit", "Mute", "Loudness",
+    "Surround", "Effect 3D", "Tone defeat", "Test", "Brightness", "Temperature",
+};
+
+static const int TX_TIMEOUT = 300;              // ms, 9600 baud frames are short
+static const int TX_RETRIES = 3;
+
+// Dallas CRC8 as _crc_ibutton_update() of avr-libc
+static quint8 crc8(const QByteArray &data)
+{
+    quint8 crc = 0;
+
+    foreach (char ch, data) {
+        crc ^= (quint8)ch;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x01) ? ((crc >> 1) ^ 0x8C) : (crc >> 1);
+    }
+
+    return crc;
+}
+
 MainWindow::MainWindow(QWidget *parent) :
-    QWidget(parent)
+    QWidget(parent),
+    txRetry(0),
+    txSeq(0)
 {
     setupUi(this);
 
     dlgSetup = new SetupDialog(this);
     sPort = new QSerialPort(this);
 
+    txTimer = new QTimer(this);
+    txTimer->setSingleShot(true);
+    txTimer->setInterval(TX_TIMEOUT);
+
     closePort();
 
     connect(pbtnSetup, &QPushButton::clicked,
@@ -21,6 +68,17 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(pbtnDisconnect, &QPushButton::clicked,
             this, &MainWindow::closePort);
 
+    // Port is read from event loop, so UI never waits for device
+    connect(sPort, &QSerialPort::readyRead,
+            this, &MainWindow::readData);
+    connect(txTimer, &QTimer::timeout,
+            this, &MainWindow::resendFrame);
+
+    connect(chbxLive, &QCheckBox::toggled,
+            this, &MainWindow::setLive);
+    connect(spbxPeriod, &QSpinBox::editingFinished,
+            this, &MainWindow::setLive);
+
     foreach (QPushButton *rcBtn, frmButtons->findChildren<QPushButton*>()) {
         connect(rcBtn, &QPushButton::clicked,
                 this, &MainWindow::sendRC);
@@ -49,26 +107,172 @@ void MainWindow::openPort()
         pbtnConnect->setEnabled(false);
         pbtnDisconnect->setEnabled(true);
         frmButtons->setEnabled(true);
+        frmMonitor->setEnabled(true);
+        setLive();
     }
 
 }
 
 void MainWindow::closePort()
 {
-    if (sPort->isOpen())
+    if (sPort->isOpen()) {
+        // Device stops streaming if it gets the frame before close
+        if (chbxLive->isChecked()) {
+            txQueue.clear();
+            sendFrame(UART_CMD_STREAM, QByteArray(1, 0));
+            sPort->waitForBytesWritten(TX_TIMEOUT);
+        }
         sPort->close();
+    }
+
+    txTimer->stop();
+    txQueue.clear();
+    rxBuf.clear();
+    spectrum->clear();
 
     pbtnConnect->setEnabled(true);
     pbtnDisconnect->setEnabled(false);
     frmButtons->setEnabled(false);
+    frmMonitor->setEnabled(false);
 }
 
 void MainWindow::sendRC()
 {
     QString cmd = sender()->property("RC").toString();
+    bool ok;
+    quint8 code = cmd.toUInt(&ok, 16);
+
+    if (ok)
+        sendFrame(UART_CMD_RC, QByteArray(1, code));
+}
 
-    if (!cmd.isEmpty() && sPort->isOpen()) {
-        cmd.prepend("RC ").append("\r\n");
-        sPort->write(cmd.toLocal8Bit());
+void MainWindow::setLive()
+{
+    quint8 period = 0;
+
+    if (chbxLive->isChecked())
+        period = spbxPeriod->value() / 10;
+    else
+        spectrum->clear();
+
+    sendFrame(UART_CMD_STREAM, QByteArray(1, period));
+}
+
+void MainWindow::sendFrame(quint8 cmd, const QByteArray &data)
+{
+    QByteArray frame;
+
+    if (!sPort->isOpen())
+        return;
+
+    frame.append((char)data.size());
+    frame.append((char)txSeq++);
+    frame.append((char)cmd);
+    frame.append(data);
+    frame.append((char)crc8(frame));
+    frame.prepend((char)UART_SYNC);
+
+    txQueue.enqueue(frame);
+    if (txQueue.size() == 1) {
+        txRetry = 0;
+        writeFrame();
     }
 }
+
+void MainWindow::writeFrame()
+{
+    if (txQueue.isEmpty())
+        return;
+
+    sPort->write(txQueue.head());
+    txTimer->start();
+}
+
+// Same SEQ is sent again, so device doesn't execute the command twice
+void MainWindow::resendFrame()
+{
+    if (++txRetry > TX_RETRIES) {
+        qDebug() << "No reply to frame" << txQueue.head().toHex();
+        txQueue.dequeue();
+        txRetry = 0;
+    }
+
+    writeFrame();
+}
+
+void MainWindow::readData()
+{
+    rxBuf.append(sPort->readAll());
+
+    while (true) {
+        int pos = rxBuf.indexOf((char)UART_SYNC);
+        if (pos < 0) {
+            rxBuf.clear();
+            return;
+        }
+        rxBuf.remove(0, pos);
+
+        // SYNC LEN SEQ CMD DATA[LEN] CRC
+        if (rxBuf.size() < 2)
+            return;
+        int len = (quint8)rxBuf.at(1);
+        if (rxBuf.size() < len + 5)
+            return;
+
+        QByteArray body = rxBuf.mid(1, len + 3);       // LEN SEQ CMD DATA
+        if ((quint8)rxBuf.at(len + 4) != crc8(body)) {
+            // Sync byte inside data, look for next one
+            rxBuf.remove(0, 1);
+            continue;
+        }
+        rxBuf.remove(0, len + 5);
+
+        parseFrame(body.at(1), body.at(2), body.mid(3));
+    }
+}
+
+void MainWindow::parseFrame(quint8 seq, quint8 cmd, const QByteArray &data)
+{
+    if (!(cmd & UART_REPLY))
+        return;
+    cmd &= ~UART_REPLY;
+
+    if (cmd == UART_CMD_TELEMETRY) {
+        showTelemetry(data);
+        return;
+    }
+
+    if (txQueue.isEmpty() || (quint8)txQueue.head().at(2) != seq ||
+        (quint8)txQueue.head().at(3) != cmd)
+        return;
+
+    if (data.isEmpty() || data.at(0) != UART_OK)
+        qDebug() << "Command" << cmd << "status" << (data.isEmpty() ? -1 : data.at(0));
+
+    txTimer->stop();
+    txQueue.dequeue();
+    txRetry = 0;
+    writeFrame();
+}
+
+void MainWindow::showTelemetry(const QByteArray &data)
+{
+    if (data.size() != UART_STREAM_LEN || !chbxLive->isChecked())
+        return;
+
+    // Status, part, bins total, mode, volume, level (2), bins
+    quint8 part = data.at(1);
+    quint8 total = data.at(2);
+    quint8 mode = data.at(3);
+    qint8 volume = data.at(4);
+    quint16 level = (quint8)data.at(5) | ((quint8)data.at(6) << 8);
+
+    if (mode < sizeof(modeNames) / sizeof(modeNames[0]))
+        lblMode->setText(QLatin1String(modeNames[mode]));
+    else
+        lblMode->setText(QString::number(mode));
+    lblVolume->setText(QString::number(volume));
+    lblLevel->setText(QString::number(level));
+
+    spectrum->setBins(total, part * UART_STREAM_BINS, data.mid(7));
+}
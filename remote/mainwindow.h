@@ -4,6 +4,8 @@
 #include "ui_mainwindow.h"
 
 #include <QSerialPort>
+#include <QQueue>
+#include <QTimer>
 
 class SetupDialog;
 
@@ -19,11 +21,25 @@ private:
     SetupDialog *dlgSetup;
     QSerialPort *sPort;
 
+    // Frames wait for ack one by one, see uart.h of firmware
+    QQueue<QByteArray> txQueue;
+    QTimer *txTimer;
+    int txRetry;
+    quint8 txSeq;
+    QByteArray rxBuf;
+
+    void sendFrame(quint8 cmd, const QByteArray &data = QByteArray());
+    void writeFrame();
+    void parseFrame(quint8 seq, quint8 cmd, const QByteArray &data);
+    void showTelemetry(const QByteArray &data);
 
 private slots:
     void openPort();
     void closePort();
     void sendRC();
+    void readData();
+    void resendFrame();
+    void setLive();
 };
 
 #endif // MAINWINDOW_H
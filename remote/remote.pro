@@ -14,10 +14,12 @@ TEMPLATE = app
 
 SOURCES += main.cpp\
         mainwindow.cpp \
-    setupdialog.cpp
+    setupdialog.cpp \
+    spectrumview.cpp
 
 HEADERS  += mainwindow.h \
-    setupdialog.h
+    setupdialog.h \
+    spectrumview.h
 
 FORMS    += mainwindow.ui \
     setupdialog.ui
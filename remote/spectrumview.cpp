@@ -0,0 +1,51 @@
+#include "spectrumview.h"
+
+#include <QPainter>
+
+SpectrumView::SpectrumView(QWidget *parent) :
+    QWidget(parent)
+{
+    setMinimumHeight(LEVELS * 2);
+}
+
+// Total is FFT_SIZE of firmware, bins are kept until parts of new data come
+void SpectrumView::setBins(int total, int offset, const QByteArray &data)
+{
+    if (offset < 0 || offset + data.size() > total)
+        return;
+
+    if (m_bins.size() != total)
+        m_bins.fill(0, total);
+
+    m_bins.replace(offset, data.size(), data);
+    update();
+}
+
+void SpectrumView::clear()
+{
+    m_bins.fill(0);
+    update();
+}
+
+void SpectrumView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    int bins = m_bins.size();
+    int half = bins / 2;
+    qreal colWidth = (qreal)width() / (bins + 1);
+    qreal rowHeight = (qreal)height() / LEVELS;
+
+    painter.fillRect(rect(), Qt::black);
+
+    for (int i = 0; i < bins; i++) {
+        int level = qMin((int)(quint8)m_bins.at(i), (int)LEVELS);
+        // Gap between channels
+        qreal x = (i < half ? i : i + 1) * colWidth;
+        qreal h = level * rowHeight;
+
+        painter.fillRect(QRectF(x, height() - h, colWidth - 1, h),
+                         i < half ? Qt::green : Qt::yellow);
+    }
+}
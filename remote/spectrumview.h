@@ -0,0 +1,29 @@
+#ifndef SPECTRUMVIEW_H
+#define SPECTRUMVIEW_H
+
+#include <QWidget>
+#include <QByteArray>
+
+// Spectrum bars as firmware buf[]: left channel bins, then right ones
+class SpectrumView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum {
+        LEVELS = 32,                    // N_DB of firmware
+    };
+
+    explicit SpectrumView(QWidget *parent = 0);
+
+    void setBins(int total, int offset, const QByteArray &data);
+    void clear();
+
+protected:
+    void paintEvent(QPaintEvent *event);
+
+private:
+    QByteArray m_bins;
+};
+
+#endif // SPECTRUMVIEW_H
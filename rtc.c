@@ -2,9 +2,15 @@
 
 #include <avr/pgmspace.h>
 #include "i2c.h"
+#include "input.h"
 
 RTC_type rtc;
 
+static uint8_t syncPolls;					// Polls left to find RTC seconds edge
+static uint8_t syncSec = 0xFF;				// RTC seconds before the edge
+static uint8_t rdSec;
+static volatile uint8_t rdState = I2C_FAILED;
+
 const static RTC_type rtcMin PROGMEM = {0, 0, 0, 1, 1, 1, 1, RTC_NOEDIT};
 const static RTC_type rtcMax PROGMEM = {59, 59, 23, 7, 31, 12, 99, RTC_NOEDIT};
 
@@ -29,7 +35,7 @@ static uint8_t rtcDaysInMonth(void)
 
 	if (ret == 2) {
 		ret = rtc.year & 0x03;
-		ret = (ret ? 29 : 28);
+		ret = (ret ? 28 : 29);
 	} else {
 		if (ret > 7)
 			ret++;
@@ -56,6 +62,77 @@ void rtcReadTime(void)
 	return;
 }
 
+// Search seconds edge of RTC chip during next polls, first skip ones read nothing
+void rtcSync(uint8_t skip)
+{
+	syncPolls = RTC_SYNC_POLLS + skip;
+	syncSec = 0xFF;
+	if (rdState != I2C_PENDING)
+		rdState = I2C_FAILED;				// Drop result of previous search
+
+	return;
+}
+
+uint8_t rtcSyncPoll(void)
+{
+	if (!syncPolls)
+		return 0;
+
+	if (--syncPolls >= RTC_SYNC_POLLS)
+		return 0;
+
+	// Result of previous queued read, new one is queued for next poll
+	if (rdState == I2C_PENDING)
+		return 0;
+	if (rdState == I2C_DONE) {
+		if (syncSec == 0xFF) {
+			syncSec = rdSec;
+		} else if (rdSec != syncSec) {
+			// New second has just begun, RAM clock starts it too
+			syncPolls = 0;
+			rtcReadTime();
+			resetClockPhase();
+			return 1;
+		}
+	}
+	if (syncPolls) {
+		I2CQueueStart(RTC_I2C_ADDR);
+		I2CQueueByte(RTC_SEC);
+		I2CQueueRead(&rdSec, 1, &rdState);
+	}
+
+	return 0;
+}
+
+void rtcTick(void)
+{
+	if (++rtc.sec > 59) {
+		rtc.sec = 0;
+		if (++rtc.min > 59) {
+			rtc.min = 0;
+			if (++rtc.hour > 23) {
+				rtc.hour = 0;
+				if (++rtc.wday > 7)
+					rtc.wday = 1;
+				if (++rtc.date > rtcDaysInMonth()) {
+					rtc.date = 1;
+					if (++rtc.month > 12) {
+						rtc.month = 1;
+						if (++rtc.year > 99)
+							rtc.year = 0;
+					}
+				}
+			}
+		}
+	}
+
+	// Once a minute check with RTC chip, its edge is expected on next tick
+	if (rtc.sec == 59 && rtc.etm == (int8_t)RTC_NOEDIT)
+		rtcSync(RTC_SYNC_SKIP);
+
+	return;
+}
+
 static void rtcSaveTime(void)
 {
 	uint8_t i;
@@ -77,6 +154,36 @@ static void rtcSaveTime(void)
 
 	I2CStop();
 
+	// Writing seconds restarts RTC second, follow it again
+	rtcSync(0);
+
+	return;
+}
+
+// Set time from other source (RDS), RTC chip is written only if it differs
+void rtcSetTime(RTC_type *time)
+{
+	uint8_t i;
+
+	if (rtc.etm != (int8_t)RTC_NOEDIT)
+		return;
+
+	for (i = RTC_MIN; i <= RTC_YEAR; i++)
+		if (*((int8_t*)&rtc + i) != *((int8_t*)time + i))
+			break;
+	if (i > RTC_YEAR && rtc.sec == time->sec)
+		return;
+
+	I2CStart(RTC_I2C_ADDR);
+	I2CWriteByte(RTC_SEC);
+	for (i = RTC_SEC; i <= RTC_YEAR; i++) {
+		*((int8_t*)&rtc + i) = *((int8_t*)time + i);
+		I2CWriteByte(rtcDecToBinDec(*((int8_t*)&rtc + i)));
+	}
+	I2CStop();
+
+	rtcSync(0);
+
 	return;
 }
 
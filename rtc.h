@@ -31,7 +31,15 @@ extern RTC_type rtc;
 
 #define RTC_NOEDIT			0xFF
 
+// RTC seconds edge search, polls are EVENT_POLL_PERIOD apart
+#define RTC_SYNC_POLLS		120			// Polls reading RTC, 1.2 s covers any phase
+#define RTC_SYNC_SKIP		90			// Polls before expected edge on minute resync
+
 void rtcReadTime(void);
+void rtcSync(uint8_t skip);
+uint8_t rtcSyncPoll(void);
+void rtcTick(void);
+void rtcSetTime(RTC_type *time);
 void rtcNextEditParam(void);
 void rtcChangeTime(int8_t diff);
 
@@ -0,0 +1,66 @@
+/*
+ * RDS decoder replay: feeds recorded groups to rdsSetBlocks() on host
+ *
+ * Built and run with 'make rds_host'. Input has one group per line as
+ * four hex words (blocks A B C D), '#' starts a comment. Decoder state
+ * changes are printed, so output can be compared with rds_groups.out.
+ */
+
+#include "../tuner/rds.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+RTC_type rtc;
+
+void rtcSetTime(RTC_type *time)
+{
+	printf("clock %02d:%02d:%02d %02d.%02d.%02d wday %d\n",
+		   time->hour, time->min, time->sec, time->date, time->month, time->year, time->wday);
+
+	return;
+}
+
+int main(int argc, char *argv[])
+{
+	FILE *in = stdin;
+	char line[128];
+	char ps[RDS_PS_LEN + 1] = "";
+	unsigned int blk[4];
+	uint8_t data[8];
+	uint8_t i;
+	int group = 0;
+
+	if (argc > 1 && !(in = fopen(argv[1], "r"))) {
+		perror(argv[1]);
+		return 1;
+	}
+
+	rdsDisable();
+
+	while (fgets(line, sizeof(line), in)) {
+		if (sscanf(line, "%x %x %x %x", &blk[0], &blk[1], &blk[2], &blk[3]) != 4)
+			continue;
+
+		for (i = 0; i < 4; i++) {
+			data[i * 2] = blk[i] >> 8;
+			data[i * 2 + 1] = blk[i];
+		}
+		rdsSetBlocks(data);
+		group++;
+
+		if (strcmp(ps, rdsGetText())) {
+			strcpy(ps, rdsGetText());
+			printf("group %d: ps \"%s\"\n", group, ps);
+		}
+	}
+
+	printf("pi %04X pty %d\n", rdsGetPi(), rdsGetPty());
+	printf("rt \"%s\"\n", rdsGetRadioText());
+	printf("af");
+	for (i = 0; i < rdsGetAfCount(); i++)
+		printf(" %d.%d", rdsGetAf(i) / 100, rdsGetAf(i) / 10 % 10);
+	printf("\n");
+
+	return 0;
+}
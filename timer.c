@@ -0,0 +1,125 @@
+#include "timer.h"
+
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include "input.h"
+
+static volatile uint32_t timerMs;					// Milliseconds since start
+static volatile uint32_t timerNext;					// Nearest deadline of pending timers
+
+static uint32_t deadline[TIMER_END];
+static uint16_t armed;								// Timers with deadline set
+static uint16_t pending;							// Armed timers not expired yet
+
+static const TimerParam timerParam[TIMER_END] PROGMEM = {
+	{EVENT_POLL_PERIOD, EVENT_POLL},				// TIMER_POLL
+	{EVENT_TUNER_PERIOD, EVENT_TUNER},				// TIMER_TUNER
+	{EVENT_BLINK_PERIOD, EVENT_BLINK},				// TIMER_BLINK
+	{1000, EVENT_TIME},								// TIMER_CLOCK
+	{0, EVENT_TEMP},								// TIMER_SENS
+	{0, 0},											// TIMER_DISPLAY
+	{0, 0},											// TIMER_INIT
+	{0, 0},											// TIMER_STBY
+	{0, 0},											// TIMER_SILENCE
+	{0, EVENT_STREAM},								// TIMER_STREAM
+};
+
+// Nearest deadline is searched with interrupts disabled, so tick can't pass it
+static void timerUpdate(void)
+{
+	uint8_t i;
+	int32_t left;
+	int32_t next = INT32_MAX;
+
+	cli();
+	for (i = 0; i < TIMER_END; i++) {
+		if (pending & (1<<i)) {
+			left = deadline[i] - timerMs;
+			if (left < next)
+				next = left;
+		}
+	}
+	// Timer which is already due expires on next tick
+	if (next < 1)
+		next = 1;
+	timerNext = timerMs + next;
+	sei();
+
+	return;
+}
+
+// Called from TIMER2_COMP_vect, returns 1 if some timer has expired
+uint8_t timerTick(void)
+{
+	return (++timerMs == timerNext);
+}
+
+uint32_t timerNow(void)
+{
+	uint32_t ret;
+
+	cli();
+	ret = timerMs;
+	sei();
+
+	return ret;
+}
+
+void timerArm(uint8_t timer, uint32_t ms)
+{
+	deadline[timer] = timerNow() + ms;
+	armed |= (1<<timer);
+	pending |= (1<<timer);
+	timerUpdate();
+
+	return;
+}
+
+void timerCancel(uint8_t timer)
+{
+	armed &= ~(1<<timer);
+	pending &= ~(1<<timer);
+	timerUpdate();
+
+	return;
+}
+
+// Milliseconds left, 0 if expired
+int32_t timerLeft(uint8_t timer)
+{
+	int32_t left;
+
+	if (!(armed & (1<<timer)))
+		return TIMER_LEFT_OFF;
+	if (!(pending & (1<<timer)))
+		return 0;
+
+	left = deadline[timer] - timerNow();
+
+	return left > 0 ? left : 0;
+}
+
+// Called from main loop on EVENT_TIMER, returns events of expired timers
+uint16_t timerProcess(void)
+{
+	uint32_t now = timerNow();
+	uint16_t ret = 0;
+	uint16_t period;
+	uint8_t i;
+
+	for (i = 0; i < TIMER_END; i++) {
+		if (!(pending & (1<<i)) || (int32_t)(deadline[i] - now) > 0)
+			continue;
+		ret |= pgm_read_word(&timerParam[i].event);
+		period = pgm_read_word(&timerParam[i].period);
+		// Periodic timer keeps its phase, late expiries are caught up
+		if (period)
+			deadline[i] += period;
+		else
+			pending &= ~(1<<i);
+	}
+
+	timerUpdate();
+
+	return ret;
+}
@@ -0,0 +1,40 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <inttypes.h>
+
+// Software timers counted in milliseconds of TIMER2_COMP_vect ticks
+enum {
+	TIMER_POLL = 0,									// Periodic, raise main loop events
+	TIMER_TUNER,
+	TIMER_BLINK,
+	TIMER_CLOCK,
+
+	TIMER_SENS,										// One-shot
+	TIMER_DISPLAY,
+	TIMER_INIT,
+	TIMER_STBY,
+	TIMER_SILENCE,
+	TIMER_STREAM,
+
+	TIMER_END
+};
+
+// Period (0 for one-shot timer) and events raised on expiry
+typedef struct {
+	uint16_t period;
+	uint16_t event;
+} TimerParam;
+
+#define TIMER_LEFT_OFF			-1				// timerLeft() of not armed timer
+
+uint8_t timerTick(void);
+uint32_t timerNow(void);
+
+void timerArm(uint8_t timer, uint32_t ms);
+void timerCancel(uint8_t timer);
+int32_t timerLeft(uint8_t timer);
+
+uint16_t timerProcess(void);
+
+#endif /* TIMER_H */
@@ -2,6 +2,7 @@
 #include "tuner.h"
 
 #include <avr/pgmspace.h>
+#include <string.h>
 #include "../i2c.h"
 
 #ifdef _RDS
@@ -25,6 +26,8 @@ static uint8_t wrBuf[14] = {
 	0,
 };
 static uint8_t rdBuf[12];
+static uint8_t rdNew[12];
+static volatile uint8_t rdState = I2C_FAILED;
 
 static void rda580xWriteI2C(uint8_t bytes)
 {
@@ -33,10 +36,10 @@ static void rda580xWriteI2C(uint8_t bytes)
 	if (tuner.ic == TUNER_RDA5802)
 		bytes = RDA5802_WR_BYTES;
 
-	I2CStart(RDA5807M_I2C_ADDR);
+	I2CQueueStart(RDA5807M_I2C_ADDR);
 	for (i = 0; i < bytes; i++)
-		I2CWriteByte(wrBuf[i]);
-	I2CStop();
+		I2CQueueByte(wrBuf[i]);
+	I2CQueueEnd();
 
 	return;
 }
@@ -89,19 +92,37 @@ void rda580xSetFreq(void)
 	return;
 }
 
+// Seek up from current channel with 100kHz spacing, stop at band limit
+void rda580xSeek(void)
+{
+	wrBuf[0] |= RDA580X_SEEKUP | RDA580X_SEEK;
+	wrBuf[1] |= RDA580X_SKMODE;
+	wrBuf[3] &= ~(RDA580X_TUNE | RDA580X_SPACE);
+	wrBuf[3] |= RDA580X_SPACE_100;
+
+	rda580xWriteI2C(RDA5802_WR_BYTES);
+
+	// Next writes should not restart seek
+	wrBuf[0] &= ~RDA580X_SEEK;
+
+	return;
+}
+
 uint8_t *rda580xReadStatus(void)
 {
-	uint8_t i;
+	uint8_t state = rdState;
 
-	I2CStart(RDA5807M_I2C_ADDR | I2C_READ);
-	for (i = 0; i < sizeof(rdBuf) - 1; i++)
-		rdBuf[i] = I2CReadByte(I2C_ACK);
-	rdBuf[sizeof(rdBuf) - 1] = I2CReadByte(I2C_NOACK);
-	I2CStop();
+	// Status of previous queued read, new one is queued for next call
+	if (state == I2C_PENDING)
+		return rdBuf;
+	if (state == I2C_DONE)
+		memcpy(rdBuf, rdNew, sizeof(rdBuf));
+	I2CQueueStart(RDA5807M_I2C_ADDR);
+	I2CQueueRead(rdNew, sizeof(rdNew), &rdState);
 
 	// Get RDS data
 #ifdef _RDS
-	if (tuner.rds) {
+	if (state == I2C_DONE && tuner.rds) {
 		/* If RDS ready and sync flag are set */
 		if ((rdBuf[0] & RDA5807_RDSR) && (rdBuf[0] & RDA5807_RDSS)) {
 			/* If there are no errors in blocks A and B */
@@ -14,7 +14,7 @@
 #define RDA5807_BASS				0b00010000 // Bass boost (1)
 #define RDA580X_RCLK_NON_CAL_MODE	0b00001000 // RCLK always on (0)
 #define RDA580X_RCLK_DIR_IN_MODE	0b00000100 // RCLK direct input mode (1)
-#define RDA580X_SEEKUP				0b00000010 // Seek up (0) / down (1)
+#define RDA580X_SEEKUP				0b00000010 // Seek up (1) / down (0)
 #define RDA580X_SEEK				0b00000001 // Stop seek (0) / start seek in SEEKUP direction (1)
 
 // 1 register (02L)
@@ -183,8 +183,12 @@
 
 #define RDA5807_BUF_READY(buf)	(buf[3] & RDA580X_FM_READY)
 #define RDA5807_BUF_STEREO(buf)	(buf[0] & RDA580X_ST)
+#define RDA580X_BUF_STC(buf)	(buf[0] & RDA580X_STC)
+#define RDA580X_BUF_SF(buf)		(buf[0] & RDA580X_SF)
+#define RDA580X_BUF_CHAN(buf)	(((buf[0] & RDA580X_READCHAN_9_8) << 8) | buf[1])
 
 #define RDA5807_CHAN_SPACING		5
+#define RDA580X_SEEK_SPACING		10
 
 #define RDA5807_VOL_MIN				0
 #define RDA5807_VOL_MAX				16
@@ -200,6 +204,7 @@
 void rda580xInit(void);
 
 void rda580xSetFreq(void);
+void rda580xSeek(void);
 
 uint8_t *rda580xReadStatus(void);
 
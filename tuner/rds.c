@@ -1,13 +1,239 @@
 #include "rds.h"
 
-static char rdsText[9];
+#include <string.h>
+#include "../rtc.h"
+
+static char rdsText[RDS_PS_LEN + 1];				// Program service shown
+static char psBuf[RDS_PS_LEN];						// Program service received
+static uint8_t psConf[RDS_PS_LEN / 2];
+static char rtText[RDS_RT_LEN + 1];					// RadioText, '\0' at carriage return
+static uint8_t rtConf[RDS_RT_LEN / 4];
+static uint8_t rtAB;								// Text A/B flag
+
+static uint16_t pi, piNew;
+static uint8_t pty, ptyNew;
+
+static uint8_t afCode[RDS_AF_MAX];					// Alternative frequencies
+static uint8_t afConf[RDS_AF_MAX];
+
+static uint32_t ctLast;								// Last clock time, minutes since MJD 0
+
 static uint8_t rdsFlag = 0;
 
+static void rdsClearText(char *text, uint8_t *conf, uint8_t len)
+{
+	memset(text, ' ', len);
+	memset(conf, 0, len / 4);
+
+	return;
+}
+
+static void rdsClear(void)
+{
+	memset(rdsText, ' ', RDS_PS_LEN);
+	memset(psBuf, ' ', RDS_PS_LEN);
+	memset(psConf, 0, sizeof(psConf));
+	rdsClearText(rtText, rtConf, RDS_RT_LEN);
+	memset(afConf, 0, sizeof(afConf));
+	pty = ptyNew = RDS_PTY_NONE;
+	ctLast = 0;
+
+	return;
+}
+
+// Segment is replaced only after its confidence drops to 0, so single
+// group with errors in blocks C/D doesn't change it
+static uint8_t rdsSetSegment(char *seg, uint8_t *conf, const char *chars, uint8_t len)
+{
+	if (!memcmp(seg, chars, len)) {
+		if (*conf < RDS_CONF_MAX)
+			(*conf)++;
+	} else if (*conf) {
+		(*conf)--;
+	} else {
+		memcpy(seg, chars, len);
+		*conf = 1;
+	}
+
+	return *conf;
+}
+
+static void rdsGetChars(char *chars, uint16_t block)
+{
+	uint8_t i;
+	char ch;
+
+	for (i = 0; i < 2; i++) {
+		ch = i ? block : block >> 8;
+		if (ch == 0x0D)
+			ch = '\0';								// End of RadioText
+		else if (ch < 0x20 || ch >= 0x80)
+			ch = ' ';
+		chars[i] = ch;
+	}
+
+	return;
+}
+
+static void rdsSetPs(uint8_t idx, uint16_t blockD)
+{
+	char chars[2];
+
+	rdsGetChars(chars, blockD);
+	if (chars[0] == '\0')
+		chars[0] = ' ';
+	if (chars[1] == '\0')
+		chars[1] = ' ';
+
+	if (rdsSetSegment(&psBuf[idx * 2], &psConf[idx], chars, 2) >= RDS_CONF_SHOW)
+		memcpy(&rdsText[idx * 2], &psBuf[idx * 2], 2);
+
+	return;
+}
+
+static void rdsSetAf(uint8_t code)
+{
+	uint8_t i;
+	uint8_t free = RDS_AF_MAX;
+
+	if (code < RDS_AF_FIRST || code > RDS_AF_LAST)
+		return;
+
+	// Code is confirmed when it comes twice, unconfirmed ones are replaced
+	// when there are no empty slots
+	for (i = 0; i < RDS_AF_MAX; i++) {
+		if (afConf[i] && afCode[i] == code) {
+			if (afConf[i] < RDS_CONF_MAX)
+				afConf[i]++;
+			return;
+		}
+		if (afConf[i] < RDS_CONF_SHOW && (free == RDS_AF_MAX || (!afConf[i] && afConf[free])))
+			free = i;
+	}
+
+	if (free < RDS_AF_MAX) {
+		afCode[free] = code;
+		afConf[free] = 1;
+	}
+
+	return;
+}
+
+static void rdsSetRt(uint8_t ab, uint8_t idx, uint16_t blockC, uint16_t blockD, uint8_t version)
+{
+	char chars[4];
+
+	// Flag change means new text
+	if (ab != rtAB) {
+		rtAB = ab;
+		rdsClearText(rtText, rtConf, RDS_RT_LEN);
+	}
+
+	if (version) {
+		// 2B: two chars in block D, 32 chars of text
+		rdsGetChars(chars, blockD);
+		rdsSetSegment(&rtText[idx * 2], &rtConf[idx], chars, 2);
+	} else {
+		rdsGetChars(&chars[0], blockC);
+		rdsGetChars(&chars[2], blockD);
+		rdsSetSegment(&rtText[idx * 4], &rtConf[idx], chars, 4);
+	}
+
+	return;
+}
+
+static void rdsSetClock(uint8_t blockB, uint16_t blockC, uint16_t blockD)
+{
+	uint32_t mjd = ((uint32_t)(blockB & 0x03) << 15) | (blockC >> 1);
+	int16_t min = (((blockC & 0x01) << 4) | (blockD >> 12)) * 60 + ((blockD >> 6) & 0x3F);
+	int16_t ofs = (blockD & 0x1F) * 30;
+	uint32_t now = mjd * 1440 + min;
+	uint16_t yp, mp, a;
+	uint8_t k;
+	RTC_type time;
+
+	if (min >= 1440)
+		return;
+
+	// Time is used only if previous one was minute ago
+	if (now != ctLast + 1) {
+		ctLast = now;
+		return;
+	}
+	ctLast = now;
+
+	// UTC => local time
+	min += (blockD & 0x20) ? -ofs : ofs;
+	if (min < 0) {
+		min += 1440;
+		mjd--;
+	} else if (min >= 1440) {
+		min -= 1440;
+		mjd++;
+	}
+
+	// MJD => date, IEC 62106 annex G in integer math
+	yp = (mjd * 100 - 1507820) / 36525;
+	a = (uint32_t)yp * 36525 / 100;
+	mp = ((mjd - 14956 - a) * 10000 - 1000) / 306001;
+	time.date = mjd - 14956 - a - (uint32_t)mp * 306001 / 10000;
+	k = (mp == 14 || mp == 15);
+	time.year = (yp + k) % 100;
+	time.month = mp - 1 - k * 12;
+	time.wday = (mjd + 3) % 7 + 1;					// 1 - Sunday
+	time.hour = min / 60;
+	time.min = min % 60;
+	time.sec = 0;
+
+	rtcSetTime(&time);
+
+	return;
+}
+
 char *rdsGetText(void)
 {
 	return rdsText;
 }
 
+char *rdsGetRadioText(void)
+{
+	return rtText;
+}
+
+uint16_t rdsGetPi(void)
+{
+	return pi;
+}
+
+uint8_t rdsGetPty(void)
+{
+	return pty;
+}
+
+uint8_t rdsGetAfCount(void)
+{
+	uint8_t i;
+	uint8_t ret = 0;
+
+	for (i = 0; i < RDS_AF_MAX; i++)
+		if (afConf[i] >= RDS_CONF_SHOW)
+			ret++;
+
+	return ret;
+}
+
+uint16_t rdsGetAf(uint8_t num)
+{
+	uint8_t i;
+
+	for (i = 0; i < RDS_AF_MAX; i++) {
+		if (afConf[i] >= RDS_CONF_SHOW && !num--)
+			return RDS_AF_BASE + afCode[i] * RDS_AF_STEP;
+	}
+
+	return 0;
+}
+
 void rdsSetBlocks(uint8_t *rdsBlock)
 {
 	// rdsBlock[0..1] - RDS block A
@@ -15,22 +241,44 @@ void rdsSetBlocks(uint8_t *rdsBlock)
 	// rdsBlock[4..5] - RDS block C
 	// rdsBlock[6..7] - RDS block D
 
-	uint8_t i;
-	char rdsChar;
+	uint16_t blockA = (rdsBlock[0] << 8) | rdsBlock[1];
+	uint16_t blockC = (rdsBlock[4] << 8) | rdsBlock[5];
+	uint16_t blockD = (rdsBlock[6] << 8) | rdsBlock[7];
 
-	uint8_t rdsVersion = (rdsBlock[2] & 0x08) >> 3;
 	uint8_t rdsGroup   = (rdsBlock[2] & 0xF0) >> 4;
-	uint8_t rdsIndex   = (rdsBlock[3] & 0x03) >> 0;
-
-	if (rdsVersion == (0x00 & 0x08)) {						// RDS version = 0
-		if (rdsGroup == (0x00 & 0xF0)) {					// RDS group = 0 (RDS0)
-			for (i = 0; i < 2; i++) {
-				rdsChar = rdsBlock[6 + i];
-				if (rdsChar >= 0x20 && rdsChar < 0x80)
-					rdsText[rdsIndex * 2 + i] = rdsChar;
-			}
-			rdsFlag = RDS_FLAG_INIT;
+	uint8_t rdsVersion = (rdsBlock[2] & 0x08) >> 3;
+	uint8_t rdsPty     = ((rdsBlock[2] & 0x03) << 3) | (rdsBlock[3] >> 5);
+
+	// PI and PTY are taken when they come twice in a row
+	if (blockA == piNew && blockA != pi) {
+		if (pi != RDS_PI_NONE)
+			rdsClear();								// Other station
+		pi = blockA;
+	}
+	piNew = blockA;
+
+	if (rdsPty == ptyNew)
+		pty = rdsPty;
+	ptyNew = rdsPty;
+
+	switch (rdsGroup) {
+	case 0:
+		rdsSetPs(rdsBlock[3] & 0x03, blockD);
+		if (!rdsVersion) {
+			rdsSetAf(rdsBlock[4]);
+			rdsSetAf(rdsBlock[5]);
 		}
+		rdsFlag = RDS_FLAG_INIT;
+		break;
+	case 2:
+		rdsSetRt(rdsBlock[3] & 0x10, rdsBlock[3] & 0x0F, blockC, blockD, rdsVersion);
+		break;
+	case 4:
+		if (!rdsVersion)
+			rdsSetClock(rdsBlock[3], blockC, blockD);
+		break;
+	default:
+		break;
 	}
 
 	return;
@@ -38,11 +286,8 @@ void rdsSetBlocks(uint8_t *rdsBlock)
 
 void rdsDisable()
 {
-	uint8_t i;
-
-	for (i = 0; i < 8; i++)
-		rdsText[i] = ' ';
-
+	rdsClear();
+	pi = piNew = RDS_PI_NONE;
 	rdsFlag = 0;
 
 	return;
@@ -5,7 +5,31 @@
 
 #define RDS_FLAG_INIT	50
 
+#define RDS_PS_LEN		8				// Program service name
+#define RDS_RT_LEN		64				// RadioText, 2A groups
+#define RDS_RT_LEN_B	32				// RadioText, 2B groups
+#define RDS_AF_MAX		8				// Alternative frequencies stored
+
+// Segment is replaced by other data only after its confidence drops to 0
+#define RDS_CONF_MAX	3
+#define RDS_CONF_SHOW	2				// Confidence to show segment
+
+#define RDS_PI_NONE		0x0000
+#define RDS_PTY_NONE	0xFF
+
+// Alternative frequency codes
+#define RDS_AF_FIRST	1				// 87.6 MHz
+#define RDS_AF_LAST		204				// 107.9 MHz
+#define RDS_AF_BASE		8750			// Tuner units, 10 kHz
+#define RDS_AF_STEP		10
+
 char *rdsGetText(void);
+char *rdsGetRadioText(void);
+uint16_t rdsGetPi(void);
+uint8_t rdsGetPty(void);
+uint8_t rdsGetAfCount(void);
+uint16_t rdsGetAf(uint8_t num);
+
 void rdsSetBlocks(uint8_t *rdsBlock);
 void rdsDisable();
 uint8_t rdsGetFlag(void);
@@ -1,6 +1,7 @@
 #include "tea5767.h"
 #include "tuner.h"
 
+#include <string.h>
 #include "../i2c.h"
 
 static uint8_t wrBuf[5] = {
@@ -11,15 +12,17 @@ static uint8_t wrBuf[5] = {
 	TEA5767_DTC,
 } ;
 static uint8_t rdBuf[5];
+static uint8_t rdNew[5];
+static volatile uint8_t rdState = I2C_FAILED;
 
 static void tea5767WriteI2C(void)
 {
 	uint8_t i;
 
-	I2CStart(TEA5767_I2C_ADDR);
+	I2CQueueStart(TEA5767_I2C_ADDR);
 	for (i = 0; i < sizeof(wrBuf); i++)
-		I2CWriteByte(wrBuf[i]);
-	I2CStop();
+		I2CQueueByte(wrBuf[i]);
+	I2CQueueEnd();
 
 	return;
 }
@@ -59,13 +62,13 @@ void tea5767SetFreq(void)
 
 uint8_t *tea5767ReadStatus(void)
 {
-	uint8_t i;
-
-	I2CStart(TEA5767_I2C_ADDR | I2C_READ);
-	for (i = 0; i < sizeof(rdBuf) - 1; i++)
-		rdBuf[i] = I2CReadByte(I2C_ACK);
-	rdBuf[sizeof(rdBuf) - 1] = I2CReadByte(I2C_NOACK);
-	I2CStop();
+	// Status of previous queued read, new one is queued for next call
+	if (rdState != I2C_PENDING) {
+		if (rdState == I2C_DONE)
+			memcpy(rdBuf, rdNew, sizeof(rdBuf));
+		I2CQueueStart(TEA5767_I2C_ADDR);
+		I2CQueueRead(rdNew, sizeof(rdNew), &rdState);
+	}
 
 	return rdBuf;
 }
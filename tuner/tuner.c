@@ -1,6 +1,7 @@
 #include "tuner.h"
 
 #include <avr/eeprom.h>
+#include <string.h>
 #include "../eeprom.h"
 
 #ifdef _TEA5767
@@ -26,9 +27,35 @@ uint8_t *bufFM;
 
 Tuner_type tuner;
 
+// Sorted station list, empty cells (0xFFFF) are at the end
+static uint16_t stations[FM_COUNT];
+static uint8_t stCnt;
+static uint16_t favStations[FM_FAV_COUNT];
+
+enum {
+	SCAN_OFF = 0,
+	SCAN_STEP,								// Tune channel and measure level
+	SCAN_SEEK,								// RDA580x hardware seek
+};
+
+static uint8_t scanState = SCAN_OFF;
+static uint8_t scanWait;
+static uint8_t scanMute;
+static uint16_t scanFreq;					// Frequency before scan
+static uint16_t scanPrev;					// Last measured channel
+static uint8_t scanPrevRank;
+static uint16_t scanPeak;					// Best channel of current station
+static uint8_t scanPeakRank;
+static uint8_t scanRank[(FM_COUNT + 1) / 2];	// 4-bit ranks of stored stations
+
 void tunerInit(void)
 {
+	uint16_t freq;
+
 	eeprom_read_block(&tuner, (void*)EEPROM_FM_TUNER, sizeof(Tuner_type));
+	if (eepromLogRead((uint8_t*)EEPROM_LOG_FM_FREQ, &freq))
+		tuner.freq = freq;
+	tunerLoadStations();
 
 	// If defined only tuner, use it despite on eeprom value
 #if   !defined(_TEA5767) && !defined(_RDA580X) && !defined(_TUX032) && !defined(_LM7001) && !defined(_LC72131)
@@ -264,25 +291,66 @@ uint8_t tunerLevel(void)
 	return ret;
 }
 
-/* Find station number (1..62) in EEPROM */
+/* Number of first station with frequency not less than freq */
+static uint8_t stationsFind(uint16_t freq)
+{
+	uint8_t lo = 0;
+	uint8_t hi = stCnt;
+	uint8_t mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) >> 1;
+		if (stations[mid] < freq)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/* Load station lists from EEPROM, stations are sorted for binary search */
+void tunerLoadStations(void)
+{
+	uint8_t i, j;
+	uint16_t freq;
+
+	eeprom_read_block(favStations, (void*)EEPROM_FAV_STATIONS, sizeof(favStations));
+	eeprom_read_block(stations, (void*)EEPROM_STATIONS, sizeof(stations));
+	eepromBind(EEPROM_BLOCK_FAV_STATIONS, favStations, (void*)EEPROM_FAV_STATIONS, sizeof(favStations));
+	eepromBind(EEPROM_BLOCK_STATIONS, stations, (void*)EEPROM_STATIONS, sizeof(stations));
+
+	// List is kept sorted by tunerStoreStation(), this only fixes external edits
+	for (i = 1; i < FM_COUNT; i++) {
+		freq = stations[i];
+		for (j = i; j && stations[j - 1] > freq; j--)
+			stations[j] = stations[j - 1];
+		stations[j] = freq;
+	}
+
+	stCnt = stationsFind(0xFFFF);
+
+	return;
+}
+
+/* Find station number (1..62) in list */
 uint8_t tunerStationNum(void)
 {
-	uint8_t i;
+	uint8_t i = stationsFind(tuner.freq);
 
-	for (i = 0; i < FM_COUNT; i++)
-		if (eeprom_read_word((uint16_t*)EEPROM_STATIONS + i) == tuner.freq)
-			return i + 1;
+	if (i < stCnt && stations[i] == tuner.freq)
+		return i + 1;
 
 	return 0;
 }
 
-/* Find favourite station number (1..10) in EEPROM */
+/* Find favourite station number (1..10) in list */
 uint8_t tunerFavStationNum(void)
 {
 	uint8_t i;
 
 	for (i = 0; i < FM_FAV_COUNT; i++)
-		if (eeprom_read_word((uint16_t*)EEPROM_FAV_STATIONS + i) == tuner.freq)
+		if (favStations[i] == tuner.freq)
 			return i + 1;
 
 	return 0;
@@ -291,30 +359,18 @@ uint8_t tunerFavStationNum(void)
 /* Find nearest next/prev stored station */
 void tunerNextStation(int8_t direction)
 {
-	uint8_t i;
-	uint16_t freqCell;
-	uint16_t freq = tuner.freq;
-
-	for (i = 0; i < FM_COUNT; i++) {
-		freqCell = eeprom_read_word((uint16_t*)EEPROM_STATIONS + i);
-		if (freqCell != 0xFFFF) {
-			if (direction == SEARCH_UP) {
-				if (freqCell > tuner.freq) {
-					freq = freqCell;
-					break;
-				}
-			} else {
-				if (freqCell < tuner.freq) {
-					freq = freqCell;
-				} else {
-					break;
-				}
-			}
-		}
+	uint8_t i = stationsFind(tuner.freq);
+
+	if (direction == SEARCH_UP) {
+		if (i < stCnt && stations[i] == tuner.freq)
+			i++;
+		if (i < stCnt)
+			tuner.freq = stations[i];
+	} else {
+		if (i)
+			tuner.freq = stations[i - 1];
 	}
 
-	tuner.freq = freq;
-
 	tunerSetFreq();
 
 	return;
@@ -323,7 +379,7 @@ void tunerNextStation(int8_t direction)
 /* Load station by number */
 void tunerLoadStation(uint8_t num)
 {
-	uint16_t freq = eeprom_read_word((uint16_t*)EEPROM_STATIONS + num);
+	uint16_t freq = stations[num];
 
 	if (freq >= tuner.fMin && freq <= tuner.fMax) {
 		tuner.freq = freq;
@@ -336,7 +392,7 @@ void tunerLoadStation(uint8_t num)
 /* Load favourite station by number */
 void tunerLoadFavStation(uint8_t num)
 {
-	uint16_t freq = eeprom_read_word((uint16_t*)EEPROM_FAV_STATIONS + num);
+	uint16_t freq = favStations[num];
 
 	if (freq >= tuner.fMin && freq <= tuner.fMax) {
 		tuner.freq = freq;
@@ -346,54 +402,253 @@ void tunerLoadFavStation(uint8_t num)
 	return;
 }
 
-/* Load favourite station by number */
+/* Save/delete favourite station */
 void tunerStoreFavStation(uint8_t num)
 {
-	uint16_t freq = eeprom_read_word((uint16_t*)EEPROM_FAV_STATIONS + num);
-
-	if (freq == tuner.freq)
-		eeprom_update_word((uint16_t*)EEPROM_FAV_STATIONS + num, 0);
+	if (favStations[num] == tuner.freq)
+		favStations[num] = 0;
 	else
-		eeprom_update_word((uint16_t*)EEPROM_FAV_STATIONS + num, tuner.freq);
+		favStations[num] = tuner.freq;
+
+	eepromDirty(EEPROM_BLOCK_FAV_STATIONS);
 
 	return;
 }
 
-/* Save/delete station from eeprom */
+/* Save/delete station, list is written to EEPROM in background */
 void tunerStoreStation(void)
 {
-	uint8_t i, j;
-	uint16_t freqCell;
-	uint16_t freq;
+	uint8_t i = stationsFind(tuner.freq);
+
+	if (i < stCnt && stations[i] == tuner.freq) {
+		memmove(&stations[i], &stations[i + 1], (FM_COUNT - 1 - i) * sizeof(stations[0]));
+		stations[FM_COUNT - 1] = 0xFFFF;
+		stCnt--;
+	} else if (i < FM_COUNT) {
+		// Last station is dropped if list is full
+		memmove(&stations[i + 1], &stations[i], (FM_COUNT - 1 - i) * sizeof(stations[0]));
+		stations[i] = tuner.freq;
+		if (stCnt < FM_COUNT)
+			stCnt++;
+	}
 
-	freq = tuner.freq;
-
-	for (i = 0; i < FM_COUNT; i++) {
-		freqCell = eeprom_read_word((uint16_t*)EEPROM_STATIONS + i);
-		if (freqCell < freq)
-			continue;
-		if (freqCell == freq) {
-			for (j = i; j < FM_COUNT; j++) {
-				if (j == FM_COUNT - 1)
-					freqCell = 0xFFFF;
-				else
-					freqCell = eeprom_read_word((uint16_t*)EEPROM_STATIONS + j + 1);
-				eeprom_update_word((uint16_t*)EEPROM_STATIONS + j, freqCell);
+	eepromDirty(EEPROM_BLOCK_STATIONS);
+
+	return;
+}
+
+static uint8_t scanGetRank(uint8_t num)
+{
+	uint8_t rank = scanRank[num >> 1];
+
+	return (num & 0x01) ? rank >> 4 : rank & 0x0F;
+}
+
+static void scanSetRank(uint8_t num, uint8_t rank)
+{
+	if (num & 0x01)
+		scanRank[num >> 1] = (scanRank[num >> 1] & 0x0F) | (rank << 4);
+	else
+		scanRank[num >> 1] = (scanRank[num >> 1] & 0xF0) | rank;
+
+	return;
+}
+
+/* Store best channel of passed station, weakest one is dropped if list is full */
+static void scanStorePeak(void)
+{
+	uint8_t i, min;
+
+	if (!scanPeakRank)
+		return;
+
+	if (stCnt == FM_COUNT) {
+		min = 0;
+		for (i = 1; i < FM_COUNT; i++)
+			if (scanGetRank(i) < scanGetRank(min))
+				min = i;
+		if (scanGetRank(min) < scanPeakRank) {
+			// Scan goes up, so list stays sorted after shift
+			for (i = min; i < FM_COUNT - 1; i++) {
+				stations[i] = stations[i + 1];
+				scanSetRank(i, scanGetRank(i + 1));
 			}
+			stCnt--;
+		}
+	}
+
+	if (stCnt < FM_COUNT) {
+		stations[stCnt] = scanPeak;
+		scanSetRank(stCnt++, scanPeakRank);
+		eepromDirty(EEPROM_BLOCK_STATIONS);
+	}
+	scanPeakRank = 0;
+
+	return;
+}
+
+/* Rank channel by level and stereo, keep best one of each station */
+static void scanMeasure(void)
+{
+	uint8_t level = tunerLevel();
+	uint8_t rank = 0;
+	uint8_t prevRank = 0;
+
+	if (level >= FM_SCAN_LEVEL)
+		rank = (level > 14 ? 14 : level) + (tunerStereo() ? 1 : 0);
+	if (tuner.freq - scanPrev <= FM_SCAN_RUN)
+		prevRank = scanPrevRank;
+	scanPrev = tuner.freq;
+	scanPrevRank = rank;
+
+	// Station takes +-100kHz, its best channel is stored when scan leaves it
+	if (tuner.freq - scanPeak > FM_SCAN_RUN)
+		scanStorePeak();
+
+	// New station starts on rising level only, so slope of strong one is skipped
+	if (rank > scanPeakRank && (scanPeakRank || rank > prevRank)) {
+		scanPeak = tuner.freq;
+		scanPeakRank = rank;
+	}
+
+	return;
+}
+
+static void scanNext(void)
+{
+	switch (tuner.ic) {
+#ifdef _RDA580X
+	case TUNER_RDA5807:
+	case TUNER_RDA5802:
+		// Hardware seek works inside 87..108MHz band only
+		if (tuner.freq >= RDA5807_BAND_CHANGE_FREQ) {
+			rda580xSeek();
+			scanState = SCAN_SEEK;
+			scanWait = FM_SCAN_SEEK_POLLS;
+			return;
+		}
+		break;
+#endif
+	default:
+		break;
+	}
+
+	tunerChangeFreq(1);
+	scanWait = FM_SCAN_SETTLE;
+
+	return;
+}
+
+/* Start auto scan of the band, found stations replace stored ones */
+uint8_t tunerScanStart(void)
+{
+	switch (tuner.ic) {
+#ifdef _TEA5767
+	case TUNER_TEA5767:
+#endif
+#ifdef _RDA580X
+	case TUNER_RDA5807:
+	case TUNER_RDA5802:
+	case TUNER_RDA5807_DF:
+#endif
+		break;
+	default:
+		return 0;
+	}
+
+	memset(stations, 0xFF, sizeof(stations));
+	eepromDirty(EEPROM_BLOCK_STATIONS);
+	stCnt = 0;
+	scanPeakRank = 0;
+	scanPrev = 0;
+	scanFreq = tuner.freq;
+	scanMute = tuner.mute;
+	tunerSetMute(1);
+
+	tuner.freq = tuner.fMin;
+	tunerSetFreq();
+	scanState = SCAN_STEP;
+	scanWait = FM_SCAN_SETTLE;
+
+	return 1;
+}
+
+/* Stop scan and tune to first found station */
+void tunerScanStop(void)
+{
+	if (scanState == SCAN_OFF)
+		return;
+
+	scanStorePeak();
+
+	tuner.freq = scanFreq;
+	if (stCnt)
+		tuner.freq = stations[0];
+	tunerSetFreq();
+	tunerSetMute(scanMute);
+
+	scanState = SCAN_OFF;
+
+	return;
+}
+
+/* Scan step, should be called on each poll event */
+void tunerScanProcess(void)
+{
+#ifdef _RDA580X
+	uint16_t freq;
+#endif
+
+	switch (scanState) {
+	case SCAN_STEP:
+		// Level is taken from status read FM_SCAN_SETTLE - 1 polls after tuning
+		tunerReadStatus();
+		if (--scanWait)
 			break;
-		} else {
-			for (j = i; j < FM_COUNT; j++) {
-				freqCell = eeprom_read_word((uint16_t*)EEPROM_STATIONS + j);
-				eeprom_update_word((uint16_t*)EEPROM_STATIONS + j, freq);
-				freq = freqCell;
-			}
+		scanMeasure();
+		if (tuner.freq >= tuner.fMax)
+			tunerScanStop();
+		else
+			scanNext();
+		break;
+#ifdef _RDA580X
+	case SCAN_SEEK:
+		tunerReadStatus();
+		if (!--scanWait) {
+			tunerScanStop();
+			break;
+		}
+		// First status after seek start may be read before it
+		if (scanWait > FM_SCAN_SEEK_POLLS - 2 || !RDA580X_BUF_STC(bufFM))
+			break;
+		freq = RDA5807_BAND_CHANGE_FREQ + RDA580X_BUF_CHAN(bufFM) * RDA580X_SEEK_SPACING;
+		if (RDA580X_BUF_SF(bufFM) || freq <= tuner.freq || freq > tuner.fMax) {
+			tunerScanStop();
 			break;
 		}
+		tuner.freq = freq;
+		scanMeasure();
+		rda580xSeek();
+		scanWait = FM_SCAN_SEEK_POLLS;
+		break;
+#endif
+	default:
+		break;
 	}
 
 	return;
 }
 
+uint8_t tunerScanning(void)
+{
+	return scanState != SCAN_OFF;
+}
+
+uint8_t tunerScanFound(void)
+{
+	return stCnt;
+}
+
 void tunerSetVolume(int8_t value)
 {
 	tuner.volume = value;
@@ -490,7 +745,7 @@ void tunerPowerOn(void)
 
 void tunerPowerOff(void)
 {
-	eeprom_update_word((uint16_t*)EEPROM_FM_FREQ, tuner.freq);
+	eepromLogWrite((uint8_t*)EEPROM_LOG_FM_FREQ, tuner.freq);
 	eeprom_update_byte((uint8_t*)EEPROM_FM_MONO, tuner.mono);
 
 	switch (tuner.ic) {
@@ -41,6 +41,12 @@ extern Tuner_type tuner;
 #define SEARCH_UP			1
 #define SEARCH_DOWN			-1
 
+// Auto scan
+#define FM_SCAN_LEVEL		5		// Minimal tunerLevel() of station
+#define FM_SCAN_RUN			10		// Channels closer than 100kHz are one station
+#define FM_SCAN_SETTLE		3		// Polls from tuning to level measurement
+#define FM_SCAN_SEEK_POLLS	250		// Hardware seek timeout
+
 void tunerInit(void);
 
 void tunerSetFreq();
@@ -53,6 +59,8 @@ void tunerSetRDS(uint8_t value);
 uint8_t tunerStereo(void);
 uint8_t tunerLevel(void);
 
+void tunerLoadStations(void);
+
 uint8_t tunerStationNum(void);
 void tunerNextStation(int8_t direction);
 void tunerLoadStation(uint8_t num);
@@ -62,6 +70,12 @@ uint8_t tunerFavStationNum(void);
 void tunerLoadFavStation(uint8_t num);
 void tunerStoreFavStation(uint8_t num);
 
+uint8_t tunerScanStart(void);
+void tunerScanStop(void);
+void tunerScanProcess(void);
+uint8_t tunerScanning(void);
+uint8_t tunerScanFound(void);
+
 void tunerSetVolume(int8_t value);
 void tunerSetMute(uint8_t value);
 void tunerSetBass(uint8_t value);
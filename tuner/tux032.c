@@ -1,19 +1,22 @@
 #include "tux032.h"
 #include "tuner.h"
 
+#include <string.h>
 #include "../i2c.h"
 
 static uint8_t wrBuf[9] = {0x80, 0x00, 0x00, 0x64, 0xB1, 0xC6, 0x4B, 0xA2, 0xD2};
 static uint8_t rdBuf[4];
+static uint8_t rdNew[4];
+static volatile uint8_t rdState = I2C_FAILED;
 
 static void tux032WriteI2C(uint8_t bytes)
 {
 	uint8_t i;
 
-	I2CStart(TUX032_I2C_ADDR);
+	I2CQueueStart(TUX032_I2C_ADDR);
 	for (i = 0; i < bytes; i++)
-		I2CWriteByte(wrBuf[i]);
-	I2CStop();
+		I2CQueueByte(wrBuf[i]);
+	I2CQueueEnd();
 
 	return;
 }
@@ -40,13 +43,13 @@ void tux032SetFreq(void)
 
 uint8_t *tux032ReadStatus(void)
 {
-	uint8_t i;
-
-	I2CStart(TUX032_I2C_ADDR | I2C_READ);
-	for (i = 0; i < sizeof(rdBuf) - 1; i++)
-		rdBuf[i] = I2CReadByte(I2C_ACK);
-	rdBuf[sizeof(rdBuf) - 1] = I2CReadByte(I2C_NOACK);
-	I2CStop();
+	// Status of previous queued read, new one is queued for next call
+	if (rdState != I2C_PENDING) {
+		if (rdState == I2C_DONE)
+			memcpy(rdBuf, rdNew, sizeof(rdBuf));
+		I2CQueueStart(TUX032_I2C_ADDR);
+		I2CQueueRead(rdNew, sizeof(rdNew), &rdState);
+	}
 
 	return rdBuf;
 }
@@ -2,16 +2,56 @@
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
 #include <string.h>
 
 #include "input.h"
 
+// Bytes passed between interrupts and main loop
+static volatile uint8_t rxBuf[UART_RX_BUF];
+static volatile uint8_t rxHead;
+static volatile uint8_t rxTail;
+
+static volatile uint8_t txBuf[UART_TX_BUF];
+static volatile uint8_t txHead;
+static volatile uint8_t txTail;
+
+// Frame or text line being received
 static struct {
+	uint8_t state;
 	uint8_t pos;
-	uint8_t ready;
-	char buf[6];
+	uint8_t len;
+	uint8_t crc;
+	uint8_t buf[UART_DATA_MAX + 2];				// SEQ CMD DATA or text line
 } uRaw;
 
+// Last frame taken, reply is sent once for it
+static struct {
+	uint8_t seq;
+	uint8_t cmd;
+	uint8_t status;
+	uint8_t wait;
+} uLast;
+
+// DATA length of commands, reads are executed again if frame is repeated
+#define UART_LEN_READ	0x80
+
+static const uint8_t cmdLen[UART_CMD_END] PROGMEM = {
+	1,									// UART_CMD_RC
+	0 | UART_LEN_READ,					// UART_CMD_STATUS
+	1 | UART_LEN_READ,					// UART_CMD_GET_PARAM
+	2,									// UART_CMD_SET_PARAM
+	1,									// UART_CMD_SET_INPUT
+	2,									// UART_CMD_SET_FREQ
+	1,									// UART_CMD_SET_MODE
+	1,									// UART_CMD_STREAM
+	1 | UART_LEN_READ,					// UART_CMD_EEP_CRC
+	2 | UART_LEN_READ,					// UART_CMD_EEP_READ
+	UART_EEP_PART + 2,					// UART_CMD_EEP_WRITE
+	0,									// UART_CMD_RESET
+};
+
 void uartInit(void)
 {
 	// Set UART prescaler (both UBRR0H and UBRR0L)
@@ -20,58 +60,220 @@ void uartInit(void)
 	// Set double transmission speed
 	UCSRA = (1<<U2X);
 
-	// Enable RX complete interrupt and receiver but not transmitter
-	UCSRB = (1<<RXCIE) | (1<<RXEN) | (0<<TXEN);
+	// Enable RX complete interrupt, receiver and transmitter.
+	// Data register empty interrupt is enabled when TX buffer has data
+	UCSRB = (1<<RXCIE) | (1<<RXEN) | (1<<TXEN);
 
 	// Set frame format (8 data bits, 1 stop bit)
 	UCSRC = (1<<URSEL) | (1<<UCSZ1) | (1<<UCSZ0);
 
+	uRaw.state = UART_RX_TEXT;
 	uRaw.pos = 0;
-	uRaw.ready = 0;
+	uLast.cmd = UART_CMD_NO;
+	uLast.wait = 0;
 
 	return;
 }
 
-static void uartWriteByte(uint8_t data)
+ISR (USART_RXC_vect)
 {
-	// Wait for empty transmit buffer
-	while (!(UCSRA & (1<<UDRE)));
+	uint8_t head = rxHead;
+	uint8_t next = (head + 1) & (UART_RX_BUF - 1);
+	uint8_t ch = UDR;
 
-	// Put data into buffer, sends data
-	UDR = data;
+	// If main loop is late, byte is lost and frame is dropped by CRC
+	if (next != rxTail) {
+		rxBuf[head] = ch;
+		rxHead = next;
+	}
+
+	setEvent(EVENT_UART);
 
 	return;
 }
 
+ISR (USART_UDRE_vect)
+{
+	uint8_t tail = txTail;
+
+	if (tail == txHead) {
+		UCSRB &= ~(1<<UDRIE);
+		return;
+	}
+
+	UDR = txBuf[tail];
+	txTail = (tail + 1) & (UART_TX_BUF - 1);
+
+	return;
+}
+
+static uint8_t uartTxFree(void)
+{
+	return (txTail - txHead - 1) & (UART_TX_BUF - 1);
+}
+
+static uint8_t uartPut(uint8_t crc, uint8_t data)
+{
+	uint8_t head = txHead;
+
+	txBuf[head] = data;
+	txHead = (head + 1) & (UART_TX_BUF - 1);
+
+	return _crc_ibutton_update(crc, data);
+}
+
 void uartWriteString(char *string)
 {
+	uint8_t len = strlen(string);
+
+	// Line is dropped if it doesn't fit
+	if (uartTxFree() < len + 2)
+		return;
+
 	while(*string)
-		uartWriteByte(*string++);
+		uartPut(0, *string++);
+
+	uartPut(0, '\r');
+	uartPut(0, '\n');
 
-	uartWriteByte('\r');
-	uartWriteByte('\n');
+	UCSRB |= (1<<UDRIE);
 
 	return;
 }
 
-ISR (USART_RXC_vect)
+// Waits until TX buffer is empty, last byte is still being shifted out
+void uartFlush(void)
 {
-	char ch = UDR;
+	while (UCSRB & (1<<UDRIE));
+
+	return;
+}
+
+// Frame is dropped if it doesn't fit
+static void uartSend(uint8_t seq, uint8_t cmd, uint8_t status, const uint8_t *data, uint8_t len)
+{
+	uint8_t crc;
+
+	if (uartTxFree() < len + 6)
+		return;
+
+	uartPut(0, UART_SYNC);
+	crc = uartPut(0, len + 1);
+	crc = uartPut(crc, seq);
+	crc = uartPut(crc, cmd | UART_REPLY);
+	crc = uartPut(crc, status);
+	while (len--)
+		crc = uartPut(crc, *data++);
+	uartPut(0, crc);
+
+	UCSRB |= (1<<UDRIE);
 
-	if (ch == '\r' || ch == '\n') {
-		if (uRaw.pos)
-			uRaw.buf[uRaw.pos] = '\0';
+	return;
+}
+
+void uartReply(uint8_t status, const uint8_t *data, uint8_t len)
+{
+	// Text lines and frames already answered
+	if (!uLast.wait)
+		return;
+	uLast.wait = 0;
+	uLast.status = status;
+
+	// If reply is lost, PC repeats the frame
+	uartSend(uLast.seq, uLast.cmd, status, data, len);
+
+	return;
+}
+
+void uartStream(const uint8_t *data, uint8_t len)
+{
+	static uint8_t seq;
+
+	uartSend(seq++, UART_CMD_TELEMETRY, UART_OK, data, len);
+
+	return;
+}
+
+// Frames with errors are answered here, good ones wait for getUartData()
+static void uartFrame(void)
+{
+	uint8_t seq = uRaw.buf[0];
+	uint8_t cmd = uRaw.buf[1];
+	uint8_t len = uRaw.len - 2;
+	uint8_t info = (cmd < UART_CMD_END ? pgm_read_byte(&cmdLen[cmd]) : 0);
+	uint8_t repeat = (seq == uLast.seq && cmd == uLast.cmd);
+
+	uLast.seq = seq;
+	uLast.cmd = cmd;
+	uLast.wait = 1;
+
+	// Reply to repeated frame was lost, don't execute it twice
+	if (repeat && !(info & UART_LEN_READ))
+		uartReply(uLast.status, 0, 0);
+	else if (cmd >= UART_CMD_END)
+		uartReply(UART_ERR_CMD, 0, 0);
+	else if (len != (info & ~UART_LEN_READ))
+		uartReply(UART_ERR_ARG, 0, 0);
+	else
+		uRaw.state = UART_RX_FRAME;
+
+	return;
+}
+
+static void uartParse(uint8_t ch)
+{
+	switch (uRaw.state) {
+	case UART_RX_LEN:
 		uRaw.pos = 0;
-		uRaw.ready = 1;
-	} else {
-		if (uRaw.pos < sizeof(uRaw.buf) - 1) {
-			uRaw.buf[uRaw.pos] = ch;
-			uRaw.pos++;
+		uRaw.len = ch + 2;
+		uRaw.crc = _crc_ibutton_update(0, ch);
+		uRaw.state = (ch <= UART_DATA_MAX ? UART_RX_BODY : UART_RX_TEXT);
+		break;
+	case UART_RX_BODY:
+		uRaw.buf[uRaw.pos++] = ch;
+		uRaw.crc = _crc_ibutton_update(uRaw.crc, ch);
+		if (uRaw.pos == uRaw.len)
+			uRaw.state = UART_RX_CRC;
+		break;
+	case UART_RX_CRC:
+		uRaw.pos = 0;
+		uRaw.state = UART_RX_TEXT;
+		if (ch == uRaw.crc)
+			uartFrame();
+		break;
+	default:
+		// Text is ASCII, so sync byte always starts a frame
+		if (ch == UART_SYNC) {
+			uRaw.state = UART_RX_LEN;
+		} else if (ch == '\r' || ch == '\n') {
+			if (uRaw.pos) {
+				uRaw.buf[uRaw.pos] = '\0';
+				uRaw.state = UART_RX_LINE;
+			}
+		} else if (uRaw.pos < sizeof(uRaw.buf) - 1) {
+			uRaw.buf[uRaw.pos++] = ch;
 		}
+		break;
+	}
+
+	return;
+}
+
+// Parses received bytes until a frame or text line is complete
+uint8_t uartProcess(void)
+{
+	uint8_t tail = rxTail;
+
+	while (uRaw.state < UART_RX_FRAME && tail != rxHead) {
+		uartParse(rxBuf[tail]);
+		tail = (tail + 1) & (UART_RX_BUF - 1);
 	}
+	rxTail = tail;
+
+	return uRaw.state >= UART_RX_FRAME;
 }
 
-static uint8_t uartParseHex(const char *hexStr)
+static uint8_t uartParseHex(const uint8_t *hexStr)
 {
 	uint8_t ret = 0;
 	uint8_t i;
@@ -94,18 +296,26 @@ static uint8_t uartParseHex(const char *hexStr)
 
 UARTData getUartData(void)
 {
-	UARTData ret = {UART_CMD_NO, CMD_RC_END};
-
-	if (uRaw.ready) {
-		uRaw.ready = 0;
-//		uartWriteString(uRaw.buf);
+	UARTData ret = {UART_CMD_NO, CMD_RC_END, 0, &uRaw.buf[2]};
 
+	if (uRaw.state == UART_RX_FRAME) {
+		ret.type = uRaw.buf[1];
+		ret.command = uRaw.buf[2];
+		if (ret.type == UART_CMD_SET_FREQ)
+			ret.value = uRaw.buf[2] | (uRaw.buf[3] << 8);
+		else
+			ret.value = (int8_t)uRaw.buf[3];
+	} else if (uRaw.state == UART_RX_LINE) {
 		// Check command type
-		if (strncmp(&uRaw.buf[0], "RC ", 3) == 0) {
+		if (strncmp((char*)&uRaw.buf[0], "RC ", 3) == 0) {
 			ret.type = UART_CMD_RC;
 			ret.command = uartParseHex(&uRaw.buf[3]);
 		}
+	}
 
+	if (uRaw.state >= UART_RX_FRAME) {
+		uRaw.pos = 0;
+		uRaw.state = UART_RX_TEXT;
 	}
 
 	return ret;
@@ -6,20 +6,81 @@
 #define USART_BAUDRATE 9600UL
 #define BAUD_PRESCALE ((F_CPU/(USART_BAUDRATE * 8)) - 1)
 
+#define UART_RX_BUF		16			// Power of 2
+#define UART_TX_BUF		32			// Power of 2
+
+// Frame: SYNC LEN SEQ CMD DATA[LEN] CRC, CRC8 (Dallas) of LEN..DATA.
+// Reply has the same SEQ, CMD | UART_REPLY and status as DATA[0].
+// Frame with SEQ and CMD of the last one is not executed again, only
+// its status is sent back. "RC xx" text lines are accepted as well.
+#define UART_SYNC		0xA5
+#define UART_REPLY		0x80
+#define UART_DATA_MAX	18
+
+// EEPROM is read and written by parts of 64-byte blocks, each block has CRC16
+// (_crc16_update() from 0), so PC sends only blocks differing from its image
+#define UART_EEP_BLOCK		64
+#define UART_EEP_PART		16
+
+// Telemetry DATA after status: part, size of buf[], mode, volume, level (2)
+// and bins part * UART_STREAM_BINS.. of buf[]. SEQ counts frames, gaps are drops.
+#define UART_STREAM_BINS	16
+#define UART_STREAM_LEN		(UART_STREAM_BINS + 6)
+
 enum {
-	UART_CMD_RC,				// Remote control command
+	UART_CMD_RC,				// RC command => status
+	UART_CMD_STATUS,			// => status, mode, input, mute, extra, volume, freq (2)
+	UART_CMD_GET_PARAM,			// Sound parameter => status, value, min, max, step
+	UART_CMD_SET_PARAM,			// Sound parameter, value => status, value
+	UART_CMD_SET_INPUT,			// Input => status
+	UART_CMD_SET_FREQ,			// Frequency (2) => status, frequency (2)
+	UART_CMD_SET_MODE,			// Display mode => status
+	UART_CMD_STREAM,			// Telemetry period, 10 ms (0 - off) => status
+	UART_CMD_EEP_CRC,			// Block => status, CRC (2)
+	UART_CMD_EEP_READ,			// Block, part => status, UART_EEP_PART bytes
+	UART_CMD_EEP_WRITE,			// Block, part, UART_EEP_PART bytes => status
+	UART_CMD_RESET,				// => status, then watchdog reset
+
+	UART_CMD_END,
 
+	UART_CMD_TELEMETRY = 0x0E,	// Sent by device only, see uartStream()
 	UART_CMD_NO = 0x0F			// No command
 };
 
+// Reply status
+enum {
+	UART_OK = 0,
+	UART_ERR_CMD,				// Unknown command
+	UART_ERR_ARG,				// Wrong data length or value
+	UART_ERR_STATE,				// Not possible now (standby or not, no tuner)
+};
+
+// Receiver state, frame or line is kept until getUartData()
+enum {
+	UART_RX_TEXT = 0,
+	UART_RX_LEN,
+	UART_RX_BODY,
+	UART_RX_CRC,
+
+	UART_RX_FRAME,
+	UART_RX_LINE,
+};
+
+// 16-bit values are little-endian
 typedef struct {
 	uint8_t type;
 	uint8_t command;
+	int16_t value;
+	const uint8_t *data;		// Frame DATA, valid until uartProcess()
 } UARTData;
 
 void uartInit(void);
 void uartWriteString(char *string);
 
+uint8_t uartProcess(void);
 UARTData getUartData(void);
+void uartReply(uint8_t status, const uint8_t *data, uint8_t len);
+void uartStream(const uint8_t *data, uint8_t len);
+void uartFlush(void);
 
 #endif // UART_H